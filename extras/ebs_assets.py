@@ -0,0 +1,50 @@
+#!/usr/bin/env python3
+#
+#  Generates src/EspBootstrapAssets.h from the files in extras/portal:
+#  every asset is gzipped and stored in PROGMEM together with its ETag.
+#
+#  Usage: python3 extras/ebs_assets.py   (from the library root)
+#
+import gzip
+import os
+import re
+import zlib
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+SRC = os.path.join(ROOT, "extras", "portal")
+OUT = os.path.join(ROOT, "src", "EspBootstrapAssets.h")
+
+HEAD = """#ifndef _ESPBOOTSTRAPASSETS_H_
+#define _ESPBOOTSTRAPASSETS_H_
+
+//  Generated by extras/ebs_assets.py from extras/portal - do not edit
+
+#include <Arduino.h>
+"""
+
+
+def symbol(name):
+    return re.sub(r"[^A-Za-z0-9]", "_", name)
+
+
+def main():
+    out = [HEAD]
+    for name in sorted(os.listdir(SRC)):
+        with open(os.path.join(SRC, name), "rb") as f:
+            raw = f.read()
+        # mtime=0 keeps the output (and the ETag) reproducible
+        gz = gzip.compress(raw, compresslevel=9, mtime=0)
+        sym = symbol(name)
+        out.append("\n//  %s: %d bytes, %d gzipped\n" % (name, len(raw), len(gz)))
+        out.append("#define EBS_ETAG_%s \"\\\"%08x\\\"\"\n" % (sym.upper(), zlib.crc32(raw) & 0xffffffff))
+        out.append("static const uint8_t __ebs_%s_gz[] PROGMEM = {\n" % sym)
+        for i in range(0, len(gz), 16):
+            out.append("  " + ", ".join("0x%02x" % b for b in gz[i:i + 16]) + ",\n")
+        out.append("};\n")
+    out.append("\n#endif // _ESPBOOTSTRAPASSETS_H_\n")
+    with open(OUT, "w") as f:
+        f.write("".join(out))
+
+
+if __name__ == "__main__":
+    main()
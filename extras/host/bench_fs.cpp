@@ -0,0 +1,85 @@
+/*
+  Latency of ParametersSPIFFS load/save and of a file open on a directory-backed filesystem
+  stand-in, with N other files on the filesystem. Every name lookup scans the whole directory,
+  like SPIFFS scanning object headers, so each exists() before an open() costs a second scan.
+
+  "load before" is the former exists() + open() path, "load after" the single open() of
+  ParametersSPIFFS::load(). Times are the best of 5 runs of 300 operations, 16-key config.
+*/
+#include <ParametersSPIFFS.h>
+#include <chrono>
+#include <dirent.h>
+#include <string>
+
+#define BENCH_RUNS  5
+#define BENCH_OPS   300
+#define BENCH_ROOT  "/tmp/fsbench"
+
+//  Name lookups scan the directory before the real call
+class ScanFS : public fs::FS {
+  public:
+    ScanFS() : fs::FS(BENCH_ROOT) {};
+    bool exists(const String& aName) { scan(aName); return fs::FS::exists(aName); };
+    fs::File open(const String& aName, const char* aMode) { scan(aName); return fs::FS::open(aName, aMode); };
+    bool remove(const String& aName) { scan(aName); return fs::FS::remove(aName); };
+
+    unsigned lookups = 0;
+
+  private:
+    void scan(const String& aName) {
+      lookups++;
+      DIR* d = opendir(BENCH_ROOT);
+      if ( d == NULL ) return;
+      volatile int found = 0;
+      while ( struct dirent* e = readdir(d) ) found += ( strcmp(e->d_name, aName.c_str() + 1) == 0 );
+      closedir(d);
+    };
+};
+
+
+template<class F> static double usPerOp(F aOp) {
+  using namespace std::chrono;
+  double best = 1e30;
+  for (int r = 0; r < BENCH_RUNS; r++) {
+    auto t = steady_clock::now();
+    for (int i = 0; i < BENCH_OPS; i++) aOp();
+    double us = (double) duration_cast<nanoseconds>(steady_clock::now() - t).count() / 1000.0 / BENCH_OPS;
+    if ( us < best ) best = us;
+  }
+  return best;
+}
+
+
+int main() {
+  ScanFS fs;
+  ParametersDictionary d;
+  for (int i = 0; i < 16; i++) d( String("key") + String(i), String("value of the key number ") + String(i) );
+
+  printf("files   open(r)   load before   load after   lookups/load   save\n");
+  for (int n : { 8, 64, 512 }) {
+    system("rm -rf " BENCH_ROOT " && mkdir -p " BENCH_ROOT);
+    for (int i = 0; i < n; i++) {
+      FILE* f = fopen( (std::string(BENCH_ROOT "/other") + std::to_string(i) + ".json").c_str(), "w" );
+      if ( f ) fclose(f);
+    }
+
+    ParametersSPIFFS p("bench", d, fs);
+    p.begin();
+    p.save();
+    ParametersDictionary e;
+    ParametersSPIFFS q("bench", e, fs);
+    q.begin();
+
+    double open = usPerOp([&]() { fs::File f = fs.open("/bench.json", "r"); f.close(); });
+    double before = usPerOp([&]() { if ( fs.exists("/bench.json") ) q.load(); });
+    double after = usPerOp([&]() { q.load(); });
+    double save = usPerOp([&]() { p.save(); });
+    fs.lookups = 0;
+    q.load();
+    unsigned perLoad = fs.lookups;
+
+    printf("%5d  %7.1f us  %9.1f us  %9.1f us   %5u -> %u   %6.1f us\n", n, open, before, after, perLoad + 1, perLoad, save);
+  }
+  system("rm -rf " BENCH_ROOT);
+  return 0;
+}
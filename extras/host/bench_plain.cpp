@@ -0,0 +1,95 @@
+/*
+  Word-at-a-time (SWAR) scan of quoted strings, __jsonconfig_plain(), against a byte loop,
+  and parse throughput of a config with long values (a PEM certificate) from a memory
+  buffer (bulk copies) and through a Stream (byte by byte).
+  The host scans 8-byte words, ESP8266 and ESP32 scan 4-byte words.
+*/
+#include <JsonConfig.h>
+#include <chrono>
+#include <string>
+
+static size_t bytewise(const char* aPos, const char* aEnd) {
+  const char* p = aPos;
+  while ( p < aEnd && *p != '\"' && *p != '\\' && *p != '\n' ) p++;
+  return p - aPos;
+}
+
+
+template<class F> static double nsPerByte(F aScan, const std::string& aText, size_t aRun) {
+  using namespace std::chrono;
+  const char* b = aText.data();
+  const char* e = b + aText.size();
+  volatile size_t sink = 0;
+  size_t bytes = 0;
+  auto t = steady_clock::now();
+  for (int r = 0; r < 200; r++) {
+    for (const char* p = b; p < e; ) {
+      size_t n = aScan(p, e);
+      sink += n;
+      bytes += n + 1;
+      p += n + 1;
+    }
+  }
+  return (double) duration_cast<nanoseconds>(steady_clock::now() - t).count() / bytes;
+}
+
+
+struct MemStream : Stream {
+  const std::string& s;
+  size_t p;
+  MemStream(const std::string& a) : s(a), p(0) {};
+  int available() { return s.size() - p; }
+  int read() { return p < s.size() ? (uint8_t) s[p++] : -1; }
+  int peek() { return p < s.size() ? (uint8_t) s[p] : -1; }
+  size_t write(uint8_t) { return 0; }
+};
+
+
+int main() {
+  //  correctness against the byte loop on random text with sparse specials
+  srand(1);
+  std::string text;
+  for (int i = 0; i < 100000; i++) {
+    int r = rand() % 64;
+    text += r == 0 ? '\"' : r == 1 ? '\\' : r == 2 ? '\n' : (char) ('a' + rand() % 26);
+  }
+  for (size_t i = 0; i < text.size(); i += 7) {
+    const char* e = text.data() + text.size();
+    if ( __jsonconfig_plain(text.data() + i, e) != bytewise(text.data() + i, e) ) {
+      printf("mismatch at %u\n", (unsigned) i);
+      return 1;
+    }
+  }
+
+  printf("%8s %12s %12s %8s\n", "run", "bytes ns/B", "swar ns/B", "speedup");
+  for (size_t run : { 8, 16, 32, 64, 256, 1024, 4096 }) {
+    std::string t;
+    while ( t.size() < 1 << 20 ) t += std::string(run, 'x') + '\"';
+    double a = nsPerByte(bytewise, t, run);
+    double b = nsPerByte(__jsonconfig_plain, t, run);
+    printf("%8u %12.3f %12.3f %7.1fx\n", (unsigned) run, a, b, a / b);
+  }
+
+  //  whole parse: config with a certificate and a few short values
+  std::string pem = "-----BEGIN CERTIFICATE-----\\n";
+  for (int i = 0; i < 24; i++) pem += std::string(64, 'A' + i % 26) + "\\n";
+  pem += "-----END CERTIFICATE-----";
+  std::string cfg = "{\"ssid\":\"home\",\"pwd\":\"secret\",\"mqtt\":{\"host\":\"broker.local\",\"port\":1883},\"ca\":\"" + pem + "\"}\n";
+
+  JsonConfig<JsonConfigBufferSource, JsonConfigDictSink> buf;
+  using namespace std::chrono;
+  const int n = 2000;
+  ParametersDictionary d;
+  auto t = steady_clock::now();
+  for (int i = 0; i < n; i++) buf.parse(cfg.c_str(), cfg.size(), d);
+  double tb = (double) duration_cast<microseconds>(steady_clock::now() - t).count() / n;
+
+  t = steady_clock::now();
+  for (int i = 0; i < n; i++) {
+    MemStream s(cfg);
+    buf.parse(s, d);
+  }
+  double ts = (double) duration_cast<microseconds>(steady_clock::now() - t).count() / n;
+  printf("parse %u bytes: buffer %.1f us, stream %.1f us (%.1fx)\n", (unsigned) cfg.size(), tb, ts, ts / tb);
+  return 0;
+}
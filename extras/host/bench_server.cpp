@@ -0,0 +1,133 @@
+/*
+  Modelled request latency of the bootstrap portal with the synchronous and the async backend.
+  Only the handler times are measured; the queueing of connections is a model with assumed
+  receive times, and neither backend serves a socket here. test_server_async.cpp drives the
+  real async backend.
+
+  Handler times are measured by running the real EspBootstrapDict handlers on the host
+  (scaled by BENCH_CPU_SCALE to approximate an 80 MHz ESP8266). Clients are simulated:
+  each opens BENCH_CONNS connections at once (page, stylesheet, status, favicon), and every
+  BENCH_SLOW-th client is slow to send its requests (captive portal probe, weak signal).
+
+  Synchronous backend: one connection at a time, the server waits for the whole request.
+  Async backend: requests are received concurrently, handlers run one at a time.
+*/
+#define private public
+#define protected public
+#include <EspBootstrapDict.h>
+#undef private
+#undef protected
+
+#include <vector>
+#include <algorithm>
+
+#ifndef BENCH_CPU_SCALE
+#define BENCH_CPU_SCALE   40      // ESP8266 at 80 MHz vs. the host
+#endif
+
+#define BENCH_CONNS       4
+#define BENCH_SLOW        4
+#define BENCH_FAST_US     3000.0  // time to receive a request
+#define BENCH_SLOW_US     250000.0
+
+struct Request {
+  double  arrive;   // connection opened
+  double  ready;    // request fully received
+  double  service;  // handler time
+  double  done;
+};
+
+
+static double measure(void (*aHandler)()) {
+  const int n = 200;
+  uint32_t t = micros();
+  for (int i = 0; i < n; i++) aHandler();
+  return (double) (micros() - t) / n * BENCH_CPU_SCALE;
+}
+
+
+static std::vector<Request> clients(int aClients, const double* aService) {
+  std::vector<Request> r;
+  srand(1);
+  for (int c = 0; c < aClients; c++) {
+    double start = rand() % 20000;
+    double rx = ( c % BENCH_SLOW == BENCH_SLOW - 1 ) ? BENCH_SLOW_US : BENCH_FAST_US;
+    for (int k = 0; k < BENCH_CONNS; k++) {
+      Request q;
+      q.arrive = start + k * 100;
+      q.ready = q.arrive + rx;
+      q.service = aService[k];
+      r.push_back(q);
+    }
+  }
+  return r;
+}
+
+
+//  Accepts connections in order of arrival and stays with each one until it is answered
+static void sync(std::vector<Request>& aReq) {
+  std::sort(aReq.begin(), aReq.end(), [](const Request& a, const Request& b) { return a.arrive < b.arrive; });
+  double t = 0;
+  for (auto& q : aReq) {
+    t = std::max(t, q.arrive);
+    t = std::max(t, q.ready);
+    t += q.service;
+    q.done = t;
+  }
+}
+
+
+//  Requests are received in parallel, handlers are serialized
+static void async(std::vector<Request>& aReq) {
+  std::sort(aReq.begin(), aReq.end(), [](const Request& a, const Request& b) { return a.ready < b.ready; });
+  double t = 0;
+  for (auto& q : aReq) {
+    t = std::max(t, q.ready) + q.service;
+    q.done = t;
+  }
+}
+
+
+static void report(const char* aName, int aClients, std::vector<Request>& aReq) {
+  std::vector<double> lat;
+  for (auto& q : aReq) lat.push_back( (q.done - q.arrive) / 1000.0 );
+  std::sort(lat.begin(), lat.end());
+  auto pct = [&](double p) { return lat[ std::min(lat.size() - 1, (size_t) (p * lat.size())) ]; };
+  printf("%-6s %3d clients: p50 %8.1f ms  p90 %8.1f ms  p99 %8.1f ms  max %8.1f ms\n", aName, aClients, pct(0.5), pct(0.9), pct(0.99), lat.back());
+}
+
+
+int main() {
+  EspBootstrapDict& bs = EspBootstrapDict::instance();
+  ParametersDictionary d;
+  d("Title", "Bootstrap");
+  d("ssid", "network");
+  d("pwd", "password");
+  d("mqtt", "broker.local");
+  bs.iDict = &d;
+  bs.iNum = 3;
+  bs.iServer = new EspBootstrapServerSync(80);
+  ESP8266WebServer& w = ((EspBootstrapServerSync*) bs.iServer)->iServer;
+
+  double service[BENCH_CONNS];
+  service[0] = measure([]() { EspBootstrapDict::instance().handleRoot(); });
+  service[1] = measure([]() { EspBootstrapDict::instance().handleCss(); });
+  service[2] = measure([]() { EspBootstrapDict::instance().handleStatus(); });
+  service[3] = service[2];  // favicon: not found, a redirect
+  w.out = String();
+  printf("model: measured handler times, assumed receive times of %.0f / %.0f us\n", BENCH_FAST_US, BENCH_SLOW_US);
+  printf("handler time (scaled x%d): root %.0f us, css %.0f us, status %.0f us\n", BENCH_CPU_SCALE, service[0], service[1], service[2]);
+
+  for (int n : { 1, 2, 4, 8, 16 }) {
+    std::vector<Request> s = clients(n, service);
+    std::vector<Request> a = s;
+    sync(s);
+    async(a);
+    report("sync", n, s);
+    report("async", n, a);
+  }
+
+  delete bs.iServer;
+  bs.iServer = NULL;
+  return 0;
+}
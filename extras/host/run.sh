@@ -0,0 +1,27 @@
+#!/bin/bash
+#  Host tests and benchmarks for the header-only library, built against the stand-in
+#  Arduino/ESP8266 headers in stub/.  Usage: ./run.sh [test_name ...]
+cd "$(dirname "$0")"
+mkdir -p build /tmp/fsroot /tmp/lfsroot
+CXX=${CXX:-g++}
+FLAGS="-std=gnu++17 -O2 -Wall -DARDUINO_ARCH_ESP8266 -D_JSON_HMAC_SOFT -Istub -I../../src -pthread"
+rc=0
+if [ $# -eq 0 ]; then
+  #  every header on its own, with the debug output compiled in
+  for h in ../../src/*.h; do
+    echo "#include <$(basename $h)>" | $CXX $FLAGS -D_LIBDEBUG_ -fsyntax-only -x c++ - || { echo "$(basename $h): _LIBDEBUG_ build FAILED"; rc=1; }
+  done
+fi
+#  a test is built once per "//  FLAGS:" line (once without one)
+for t in ${@:-$(ls test_*.cpp | sed 's/\.cpp$//')}; do
+  n=0
+  while IFS= read -r extra; do
+    out=build/$t; [ $n -gt 0 ] && out=build/$t.$n
+    n=$((n+1))
+    if ! $CXX $FLAGS $extra $t.cpp stub/stubs.cpp -o $out; then
+      echo "$t $extra: build FAILED"; rc=1; continue
+    fi
+    ./$out || rc=1
+  done < <(grep -q '^//  FLAGS:' $t.cpp && sed -n 's|^//  FLAGS: *||p' $t.cpp || echo)
+done
+exit $rc
@@ -0,0 +1,90 @@
+#pragma once
+#include <string>
+#include <cstring>
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <cctype>
+#include <chrono>
+#include <thread>
+#define PROGMEM
+#define PGM_P const char*
+#define pgm_read_byte(p) (*(const uint8_t*)(p))
+#define memcpy_P memcpy
+#define strlen_P strlen
+#define HEX 16
+inline uint32_t millis(){ using namespace std::chrono; static auto s=steady_clock::now(); return (uint32_t)duration_cast<milliseconds>(steady_clock::now()-s).count(); }
+inline uint32_t micros(){ using namespace std::chrono; static auto s=steady_clock::now(); return (uint32_t)duration_cast<microseconds>(steady_clock::now()-s).count(); }
+inline void delay(uint32_t ms){ std::this_thread::sleep_for(std::chrono::milliseconds(ms)); }
+inline void yield(){ std::this_thread::yield(); }
+class String {
+ public:
+  std::string s;
+  String() {}
+  String(const char* c){ if(c) s=c; }
+  String(const std::string& x):s(x){}
+  String(char c):s(1,c){}
+  String(int v){ s=std::to_string(v);} 
+  String(unsigned v, int base){ char b[16]; snprintf(b,16,base==16?"%x":"%u",v); s=b;}
+  const char* c_str() const { return s.c_str(); }
+  unsigned length() const { return s.size(); }
+  bool concat(char c){ s+=c; return true;}
+  bool concat(const char* c){ s+=c; return true;}
+  bool concat(const String& c){ s+=c.s; return true;}
+  bool concat(const char* c, unsigned n){ s.append(c,n); return true;}
+  bool reserve(unsigned n){ s.reserve(n); return true;}
+  String& operator+=(const String& o){ s+=o.s; return *this;}
+  String& operator+=(const char* o){ s+=o; return *this;}
+  String& operator+=(char o){ s+=o; return *this;}
+  friend String operator+(const String& a, const String& b){ return String(a.s+b.s);} 
+  friend String operator+(const String& a, const char* b){ return String(a.s+b);} 
+  friend String operator+(const char* a, const String& b){ return String(std::string(a)+b.s);} 
+  bool operator==(const String& o) const { return s==o.s; }
+  bool operator==(const char* o) const { return s==o; }
+  bool operator!=(const String& o) const { return s!=o.s; }
+  bool operator!=(const char* o) const { return s!=o; }
+  char operator[](unsigned i) const { return s[i]; }
+  char charAt(unsigned i) const { return s[i]; }
+  int indexOf(const char* x) const { auto p=s.find(x); return p==std::string::npos?-1:(int)p; }
+  int indexOf(char x) const { auto p=s.find(x); return p==std::string::npos?-1:(int)p; }
+  bool startsWith(const String& x) const { return s.rfind(x.s,0)==0; }
+  void toUpperCase(){ for(auto&c:s) c=toupper(c);} 
+  void toLowerCase(){ for(auto&c:s) c=tolower(c);} 
+  void replace(const char* a, const char* b){ std::string A(a),B(b); size_t p=0; while((p=s.find(A,p))!=std::string::npos){ s.replace(p,A.size(),B); p+=B.size(); } }
+  int toInt() const { return atoi(s.c_str()); }
+  String substring(unsigned a) const { return String(s.substr(a)); }
+  String substring(unsigned a, unsigned b) const { return String(s.substr(a,b-a)); }
+  void remove(unsigned i){ if(i<s.size()) s.erase(i); }
+  bool concat(unsigned v){ s+=std::to_string(v); return true;}
+};
+class Print { public:
+  virtual size_t write(uint8_t) = 0;
+  virtual size_t write(const uint8_t* b, size_t n){ size_t r=0; while(n--) r+=write(*b++); return r; }
+  size_t print(const String& x){ return write((const uint8_t*)x.c_str(), x.length()); }
+  size_t print(const char* x){ return write((const uint8_t*)x, strlen(x)); }
+  size_t print(char c){ return write((uint8_t)c); }
+  size_t print(int x){ return print(String(x)); }
+  size_t println(){ return print("\n"); }
+  template<class T> size_t println(const T& x){ size_t r=print(x); return r+println(); }
+  template<class... A> size_t printf(const char* f, A... a){ char b[512]; snprintf(b,512,f,a...); return print(b); }
+  virtual ~Print(){}
+};
+class Stream : public Print { public:
+  virtual int available() = 0; virtual int read() = 0; virtual int peek() = 0;
+  virtual size_t readBytes(char* b, size_t n){ size_t i=0; while(i<n){ int c=read(); if(c<0) break; b[i++]=c;} return i; }
+  size_t readBytes(uint8_t* b, size_t n){ return readBytes((char*)b,n); }
+  virtual void flush(){}
+};
+class HardwareSerial : public Stream { public:
+  size_t write(uint8_t c) override { putchar(c); return 1; }
+  int available() override { return 0; } int read() override { return -1; } int peek() override { return -1; }
+  void begin(long){}
+};
+extern HardwareSerial Serial;
+class EspClass { public:
+  uint32_t rtc[128];
+  uint32_t getChipId(){ return 0x123456; }
+  bool rtcUserMemoryRead(uint32_t o, uint32_t* d, size_t n){ if ( o * 4 + n > sizeof rtc ) return false; memcpy(d, rtc + o, n); return true; }
+  bool rtcUserMemoryWrite(uint32_t o, uint32_t* d, size_t n){ if ( o * 4 + n > sizeof rtc ) return false; memcpy(rtc + o, d, n); return true; }
+};
+extern EspClass ESP;
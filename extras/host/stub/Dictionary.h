@@ -0,0 +1,25 @@
+#pragma once
+#define DICTIONARY_STUB
+#include <Arduino.h>
+#include <vector>
+#include <utility>
+class Dictionary { public:
+  std::vector<std::pair<String,String>> v;
+  Dictionary(int n=10){}
+  int8_t insert(const char* k, const char* x){ return insert(String(k),String(x)); }
+  int8_t insert(const String& k, const String& x){ for(auto&p:v) if(p.first==k){p.second=x; return 0;} v.push_back({k,x}); return 0; }
+  int8_t operator()(const String& k, const String& x){ return insert(k,x); }
+  String operator()(unsigned i){ return i<v.size()?v[i].first:String(); }
+  String operator[](unsigned i){ return i<v.size()?v[i].second:String(); }
+  String operator[](int i){ return (*this)[(unsigned)i]; }
+  String operator[](const String& k){ for(auto&p:v) if(p.first==k) return p.second; return String(); }
+  String operator[](const char* k){ return (*this)[String(k)]; }
+  String search(const String& k){ return (*this)[k]; }
+  int8_t remove(const String& k){ for(size_t i=0;i<v.size();i++) if(v[i].first==k){ v.erase(v.begin()+i); return 0;} return 0; }
+  unsigned count(){ return v.size(); }
+  size_t esize(){ size_t s=0; for(auto&p:v) s+=p.first.length()+p.second.length()+2; return s; }
+  size_t size(){ return esize(); }
+  void destroy(){ v.clear(); }
+  int8_t merge(Dictionary& o){ for(auto&p:o.v) insert(p.first,p.second); return 0; }
+  String json(){ String s("{"); for(size_t i=0;i<v.size();i++){ s+="\""; s+=v[i].first; s+="\":\""; s+=v[i].second; s+="\""; if(i+1<v.size()) s+=","; } s+="}"; return s; }
+};
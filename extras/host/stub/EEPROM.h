@@ -0,0 +1,7 @@
+#pragma once
+#include <Arduino.h>
+#include <atomic>
+struct EEPROMClass { uint8_t d[4096]; std::atomic<int> commits{0}; std::atomic<int> writes{0};
+  EEPROMClass(){ memset(d,0xff,sizeof d);} void begin(size_t){} bool commit(){ commits++; return true;} void end(){ commit(); }   // end() commits, as on ESP8266
+  uint8_t read(int a){ return d[a]; } void write(int a, uint8_t v){ writes++; d[a]=v; } };
+extern EEPROMClass EEPROM;
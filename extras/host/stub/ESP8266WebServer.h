@@ -0,0 +1,25 @@
+#pragma once
+#include <ESP8266WiFi.h>
+#include <functional>
+#include <map>
+#include <vector>
+enum HTTPMethod { HTTP_ANY, HTTP_GET, HTTP_POST };
+#define CONTENT_LENGTH_UNKNOWN ((size_t)-1)
+class ESP8266WebServer { public:
+  typedef std::function<void(void)> THandlerFunction;
+  std::vector<std::pair<String,String>> args_; std::vector<std::pair<String,String>> hdrs_; String out; int code=0; std::map<std::string,THandlerFunction> h; THandlerFunction nf; String uri_="/";
+  ESP8266WebServer(int){}
+  void on(const String& u, THandlerFunction f){ h[u.s]=f; } void on(const String& u, HTTPMethod, THandlerFunction f){ h[u.s]=f; }
+  void onNotFound(THandlerFunction f){ nf=f; } void begin(){} void handleClient(){} void stop(){} void close(){}
+  void setContentLength(size_t){} void send(int c, const char* t, const String& b){ code=c; out+=b; } void send(int c, const char* t, const char* b){ code=c; out+=b; }
+  void send(int c){ code=c; }
+  void send_P(int c, const char* t, const char* b, size_t n){ code=c; out.concat(b,n); }
+  void sendContent(const String& s){ out+=s; } void sendContent(const char* s){ out+=s; } void sendContent_P(const char* s, size_t n){ out.concat(s,n); }
+  void sendHeader(const String& n, const String& v, bool=false){ hdrs_.push_back({n,v}); }
+  int args(){ return args_.size(); } String arg(int i){ return args_[i].second; } String arg(const String& n){ for(auto&a:args_) if(a.first==n) return a.second; return String(); }
+  bool hasArg(const String& n){ for(auto&a:args_) if(a.first==n) return true; return false; }
+  String header(const String& n){ for(auto&a:hdrs_) if(a.first==n) return a.second; return String(); } bool hasHeader(const String& n){ return header(n).length()>0; }
+  void collectHeaders(const char**, size_t){}
+  String uri(){ return uri_; }
+  void call(const char* u){ out=String(); code=0; uri_=u; auto it=h.find(u); if(it!=h.end()) it->second(); else nf(); }
+};
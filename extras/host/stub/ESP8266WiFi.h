@@ -0,0 +1,19 @@
+#pragma once
+#include <Arduino.h>
+#define WL_CONNECTED 3
+#define WIFI_STA 1
+#define WIFI_AP 2
+#define WIFI_AP_STA 3
+#define WIFI_SCAN_RUNNING (-1)
+#define WIFI_SCAN_FAILED (-2)
+struct IPAddress { uint32_t a; IPAddress(uint32_t x=0):a(x){} IPAddress(int a0,int b,int c,int d):a(a0|b<<8|c<<16|d<<24){} operator uint32_t() const {return a;} String toString() const { return String("1.2.3.4"); } };
+struct WiFiClass { int st=0; uint8_t bs[6]={1,2,3,4,5,6}; String ss="net"; String pw; String good;
+ void mode(int){} int getMode(){return 1;} int status(){return st;}
+ void begin(const char* s, const char* p, int32_t ch=0, const uint8_t* b=nullptr, bool c=true){ ss=s; pw=p; st=( good.length()==0 || good==s ) ? WL_CONNECTED : 0; }
+ String psk(){return pw;}
+ void disconnect(bool=false){} bool config(IPAddress,IPAddress,IPAddress,IPAddress=IPAddress()){return true;}
+ String SSID(){return ss;} String SSID(int i){return scanS[i];} int32_t RSSI(int i){return scanR[i];} uint8_t encryptionType(int){return 0;} uint8_t* BSSID(){return bs;} int32_t channel(){return 6;}
+ IPAddress localIP(){return 1;} IPAddress gatewayIP(){return 2;} IPAddress subnetMask(){return 3;} IPAddress dnsIP(int=0){return 4;}
+ String macAddress(){return "AA:BB:CC:DD:EE:FF";} uint8_t* macAddress(uint8_t* m){ for(int i=0;i<6;i++) m[i]=0xAA+i; return m;} bool softAP(const char*){return true;} bool softAPdisconnect(bool=false){return true;} bool softAPConfig(IPAddress,IPAddress,IPAddress){return true;}
+ int8_t scanNetworks(bool async=false, bool hidden=false){ return async?-1:scanN;} int8_t scanComplete(){ return scanN;} const char* scanS[8]; int scanR[8]; int scanN=0; void scanDelete(){} };
+extern WiFiClass WiFi;
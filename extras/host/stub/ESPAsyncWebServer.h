@@ -0,0 +1,39 @@
+#pragma once
+#include <ESP8266WiFi.h>
+#include <functional>
+#include <vector>
+//  Stand-in for ESPAsyncWebServer. The host drives a connection with accept() (headers parsed),
+//  receive() (a body chunk, as the TCP stack delivers it) and complete() (request handler runs).
+typedef enum { HTTP_GET = 1, HTTP_POST = 2, HTTP_ANY = 127 } WebRequestMethod;
+struct AsyncWebHeader { String n, v; const String& value() const { return v; } };
+struct AsyncWebServerResponse { int code=200; String type, content; std::vector<AsyncWebHeader> hdrs; virtual ~AsyncWebServerResponse(){}
+  void addHeader(const String& n, const String& v){ hdrs.push_back({n,v}); } void setCode(int c){ code=c; } };
+struct AsyncResponseStream : AsyncWebServerResponse, Print { size_t write(uint8_t c){ content.concat((const char*)&c,1); return 1; } };
+struct AsyncWebServerRequest;
+typedef std::function<void(AsyncWebServerRequest*)> ArRequestHandlerFunction;
+typedef std::function<void(AsyncWebServerRequest*, const String&, size_t, uint8_t*, size_t, bool)> ArUploadHandlerFunction;
+typedef std::function<void(AsyncWebServerRequest*, uint8_t*, size_t, size_t, size_t)> ArBodyHandlerFunction;
+struct AsyncWebServerRequest {
+  void* _tempObject=NULL; String url; int method=HTTP_GET; size_t length=0; std::vector<AsyncWebHeader> args_, hdrs_; AsyncWebServerResponse* response=NULL;
+  ArRequestHandlerFunction onRequest; ArBodyHandlerFunction onBody;
+  ~AsyncWebServerRequest(){ free(_tempObject); delete response; }
+  size_t contentLength(){ return length; } size_t args(){ return args_.size(); } const String& arg(size_t i){ return args_[i].v; }
+  String arg(const String& n){ for(auto&a:args_) if(a.n==n) return a.v; return String(); } bool hasArg(const char* n){ for(auto&a:args_) if(a.n==n) return true; return false; }
+  AsyncWebHeader* getHeader(const String& n){ for(auto&h:hdrs_) if(h.n==n) return &h; return NULL; }
+  void send(AsyncWebServerResponse* r){ delete response; response=r; } void send(int c){ AsyncWebServerResponse* r=new AsyncWebServerResponse; r->code=c; send(r); }
+  AsyncResponseStream* beginResponseStream(const String& t){ AsyncResponseStream* r=new AsyncResponseStream; r->type=t; return r; }
+  AsyncWebServerResponse* beginResponse_P(int c, const String& t, const uint8_t* d, size_t n){ AsyncWebServerResponse* r=new AsyncWebServerResponse; r->code=c; r->type=t; r->content.concat((const char*)d,n); return r; }
+};
+class AsyncWebServer { public:
+  struct Route { String uri; int method; ArRequestHandlerFunction req; ArBodyHandlerFunction body; };
+  std::vector<Route> routes; ArRequestHandlerFunction nf;
+  AsyncWebServer(uint16_t){} void begin(){} void end(){}
+  void on(const char* u, int m, ArRequestHandlerFunction f){ routes.push_back({u,m,f,NULL}); }
+  void on(const char* u, int m, ArRequestHandlerFunction f, ArUploadHandlerFunction, ArBodyHandlerFunction b){ routes.push_back({u,m,f,b}); }
+  void onNotFound(ArRequestHandlerFunction f){ nf=f; }
+  AsyncWebServerRequest* accept(int m, const char* u, size_t len=0){ AsyncWebServerRequest* r=new AsyncWebServerRequest; r->method=m; r->url=u; r->length=len; r->onRequest=nf;
+    for(auto& x:routes) if(x.uri==u && (x.method & m)){ r->onRequest=x.req; r->onBody=x.body; break; }
+    return r; }
+  void receive(AsyncWebServerRequest* r, const uint8_t* d, size_t n, size_t i, size_t t){ if(r->onBody) r->onBody(r,(uint8_t*)d,n,i,t); }
+  void complete(AsyncWebServerRequest* r){ if(r->onRequest) r->onRequest(r); }
+};
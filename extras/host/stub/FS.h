@@ -0,0 +1,35 @@
+#pragma once
+#include <Arduino.h>
+#include <cstdio>
+#include <sys/stat.h>
+namespace fs {
+inline bool& failWrites() { static bool f = false; return f; }   // simulates a full filesystem
+class File : public Stream { public:
+  FILE* f=nullptr; std::string n;
+  File(){} File(FILE* x, std::string nm):f(x),n(nm){}
+  operator bool() const { return f!=nullptr; }
+  int available() override { if(!f) return 0; long p=ftell(f); fseek(f,0,SEEK_END); long e=ftell(f); fseek(f,p,SEEK_SET); return e-p; }
+  int read() override { return f?fgetc(f):-1; }
+  int peek() override { if(!f) return -1; int c=fgetc(f); if(c>=0) ungetc(c,f); return c; }
+  size_t readBytes(char* b, size_t n) override { return f?fread(b,1,n,f):0; }
+  size_t read(uint8_t* b, size_t n){ return f?fread(b,1,n,f):0; }
+  size_t write(uint8_t c) override { return f&&!failWrites()?fwrite(&c,1,1,f):0; }
+  size_t write(const uint8_t* b, size_t n) override { return f&&!failWrites()?fwrite(b,1,n,f):0; }
+  size_t size(){ return available(); }
+  bool isDirectory(){ return false; }
+  void close(){ if(f) fclose(f); f=nullptr; }
+  void flush() override { if(f) fflush(f); }
+};
+class FS { public: std::string root;   // virtual: a benchmark could model the lookup cost of a filesystem
+  FS(const char* r):root(r){} virtual ~FS(){}
+  std::string p(const String& x){ return root + x.s; }
+  virtual bool exists(const String& x){ struct stat st; return stat(p(x).c_str(),&st)==0; }
+  virtual File open(const String& x, const char* m){ FILE* f=fopen(p(x).c_str(), m[0]=='w'?"wb":(m[0]=='a'?"ab":"rb")); return File(f,x.s); }
+  virtual bool remove(const String& x){ return ::remove(p(x).c_str())==0; }
+  virtual bool rename(const String& a, const String& b){ return ::rename(p(a).c_str(),p(b).c_str())==0; }
+  bool begin(){ return true; }
+};
+}
+using fs::File; using fs::FS;
+extern fs::FS SPIFFS;
+extern fs::FS LittleFS;
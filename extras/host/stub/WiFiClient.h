@@ -0,0 +1,3 @@
+#pragma once
+#include <ESP8266WiFi.h>
+struct WiFiClient {};
@@ -0,0 +1,9 @@
+#include <FS.h>
+#include <ESP8266WiFi.h>
+#include <Arduino.h>
+#include <EEPROM.h>
+#include <ESP8266HTTPClient.h>
+HardwareSerial Serial; EspClass ESP; EEPROMClass EEPROM;
+WiFiClass WiFi;
+fs::FS SPIFFS("/tmp/fsroot"); fs::FS LittleFS("/tmp/lfsroot");
+std::string HTTPClient::body, HTTPClient::mac; int HTTPClient::size = -2;
@@ -0,0 +1,105 @@
+/*
+  Host test of batched saves: three parameter objects saved inside beginBatch() /
+  commitBatch() commit the EEPROM (one flash sector erase) exactly once, and the
+  save() of destructors running inside a batch does not commit either.
+*/
+#define EEPROM_MAX 4096
+#include <ParametersEEPROM.h>
+#include <ParametersEEPROMMap.h>
+
+static int fails = 0;
+#define CHECK(c) do { if ( !(c) ) { printf("FAIL %s:%d %s\n", __FILE__, __LINE__, #c); fails++; } } while (0)
+
+struct Net {
+  char token[5];
+  char host[32];
+};
+
+
+int main() {
+  Dictionary wifi, mqtt;
+  wifi("ssid", "net");
+  wifi("pwd", "secret");
+  mqtt("host", "broker.local");
+  Net net = { "NET1", "10.1.1.1" };
+
+  ParametersEEPROM a("WIFI", wifi, 0, 512);
+  ParametersEEPROM b("MQTT", mqtt, 512, 512);
+  ParametersEEPROMMap c("NET1", &net, NULL, 1024, sizeof(Net));
+  CHECK( a.begin() == PARAMS_OK && b.begin() == PARAMS_OK && c.begin() == PARAMS_OK );
+
+  //  outside a batch every save commits
+  int c0 = EEPROM.commits;
+  a.save();
+  b.save();
+  CHECK( EEPROM.commits == c0 + 2 );
+
+  //  three saves in a batch: one commit, when the batch is committed
+  c0 = EEPROM.commits;
+  ParametersBase::beginBatch();
+  wifi("ssid", "net2");
+  mqtt("host", "broker2.local");
+  strcpy(net.host, "10.1.1.2");
+  CHECK( a.save() == PARAMS_OK );
+  CHECK( b.save() == PARAMS_OK );
+  CHECK( c.save() == PARAMS_OK );
+  CHECK( EEPROM.commits == c0 );
+  CHECK( ParametersBase::commitBatch() == PARAMS_OK );
+  CHECK( EEPROM.commits == c0 + 1 );
+
+  //  nested batches commit with the outermost one
+  c0 = EEPROM.commits;
+  ParametersBase::beginBatch();
+  ParametersBase::beginBatch();
+  wifi("pwd", "secret2");     // unchanged images are not written again
+  mqtt("port", "1883");
+  a.save();
+  CHECK( ParametersBase::commitBatch() == PARAMS_OK );
+  CHECK( EEPROM.commits == c0 );
+  b.save();
+  CHECK( ParametersBase::commitBatch() == PARAMS_OK );
+  CHECK( EEPROM.commits == c0 + 1 );
+
+  //  objects going out of scope inside a batch save, but do not commit (nor end() the EEPROM)
+  c0 = EEPROM.commits;
+  ParametersBase::beginBatch();
+  {
+    Dictionary t;
+    t("k", "v");
+    ParametersEEPROM x("TMP1", t, 1536, 256);
+    ParametersEEPROM y("TMP2", t, 1792, 256);
+    Net n = { "TMP3", "host" };
+    ParametersEEPROMMap z("TMP3", &n, NULL, 2048, sizeof(Net));
+    x.begin();
+    y.begin();
+    z.begin();
+  }
+  CHECK( EEPROM.commits == c0 );
+  CHECK( ParametersBase::commitBatch() == PARAMS_OK );
+  CHECK( EEPROM.commits == c0 + 1 );
+
+  //  nothing pending: an empty batch does not commit
+  c0 = EEPROM.commits;
+  ParametersBase::beginBatch();
+  CHECK( ParametersBase::commitBatch() == PARAMS_OK );
+  CHECK( EEPROM.commits == c0 );
+
+  //  the batched values were all written
+  {
+    Dictionary w, t;
+    ParametersEEPROM r("WIFI", w, 0, 512);
+    ParametersEEPROM s("TMP2", t, 1792, 256);
+    r.begin();
+    s.begin();
+    CHECK( r.load() == PARAMS_OK && w["ssid"] == "net2" );
+    CHECK( s.load() == PARAMS_OK && t["k"] == "v" );
+    Net m;
+    ParametersEEPROMMap q("NET1", &m, NULL, 1024, sizeof(Net));
+    q.begin();
+    CHECK( q.load() == PARAMS_OK && strcmp(m.host, "10.1.1.2") == 0 );
+  }
+
+  if ( fails ) return 1;
+  printf("test_batch: passed\n");
+  return 0;
+}
@@ -0,0 +1,100 @@
+/*
+  Host test of the bootstrap /config handler: the body is staged, unknown keys
+  are rejected, and the dictionary (or map) is only updated by a complete parse.
+*/
+#define private public
+#define protected public
+#include <EspBootstrapDict.h>
+#include <EspBootstrapMap.h>
+#undef private
+#undef protected
+
+static int fails = 0;
+#define CHECK(c) do { if ( !(c) ) { printf("FAIL %s:%d %s\n", __FILE__, __LINE__, #c); fails++; } } while (0)
+
+static ESP8266WebServer& post(EspBootstrapBase& aBs, const char* aBody) {
+  ESP8266WebServer& w = ((EspBootstrapServerSync*) aBs.iServer)->iServer;
+  w.args_.clear();
+  w.args_.push_back({"plain", aBody});
+  w.out = String();
+  return w;
+}
+
+
+static void dict() {
+  EspBootstrapDict& bs = EspBootstrapDict::instance();
+  ParametersDictionary d;
+  d("Title", "T");
+  d("ssid", "s");
+  d("pwd", "p");
+  bs.iDict = &d;
+  bs.iNum = 2;
+  bs.iServer = new EspBootstrapServerSync(80);
+
+  //  unknown key: nothing applied, not even the values before it
+  ESP8266WebServer& w = post(bs, "{\"ssid\":\"home\",\"x\":\"1\"}");
+  bs.handleConfig();
+  CHECK( w.code == 400 );
+  CHECK( d["ssid"] == "s" );
+  CHECK( d.count() == 3 );
+  CHECK( !bs.iAllDone );
+
+  //  broken body after a good value: nothing applied
+  post(bs, "{\"ssid\":\"home\" \"pwd\"}");
+  bs.handleConfig();
+  CHECK( w.code == 400 );
+  CHECK( d["ssid"] == "s" );
+
+  post(bs, "{\"ssid\":\"home\",\n\"pwd\":\"secret\"}");
+  bs.handleConfig();
+  CHECK( w.code == 200 );
+  CHECK( w.out == "{\"rc\":0,\"count\":2}" );
+  CHECK( d["ssid"] == "home" );
+  CHECK( d["pwd"] == "secret" );
+  CHECK( bs.iAllDone );
+
+  delete bs.iServer;
+  bs.iServer = NULL;
+}
+
+
+static void map() {
+  EspBootstrapMap& bs = EspBootstrapMap::instance();
+  char a[20] = "s", b[20] = "p";
+  char* m[] = { a, b };
+  const char* t[] = { "T", "ssid", "pwd" };
+  bs.iMap = m;
+  bs.iTitles = t;
+  bs.iNum = 2;
+  bs.iServer = new EspBootstrapServerSync(80);
+
+  ESP8266WebServer& w = post(bs, "{\"ssid\":\"home\",\"z\":\"1\"}");
+  bs.handleConfig();
+  CHECK( w.code == 400 );
+  CHECK( strcmp(a, "s") == 0 );
+
+  //  values go to the fields with matching titles, in any order
+  post(bs, "{\"pwd\":\"secret\",\"ssid\":\"home\"}");
+  bs.handleConfig();
+  CHECK( w.code == 200 );
+  CHECK( strcmp(a, "home") == 0 );
+  CHECK( strcmp(b, "secret") == 0 );
+
+  //  a partial body leaves the other fields alone
+  post(bs, "{\"pwd\":\"other\"}");
+  bs.handleConfig();
+  CHECK( w.code == 200 );
+  CHECK( strcmp(a, "home") == 0 );
+  CHECK( strcmp(b, "other") == 0 );
+
+  delete bs.iServer;
+  bs.iServer = NULL;
+}
+
+
+int main() {
+  dict();
+  map();
+  printf("test_bootstrap_config: %s\n", fails ? "FAILED" : "passed");
+  return fails ? 1 : 0;
+}
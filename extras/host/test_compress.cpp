@@ -0,0 +1,101 @@
+/*
+  Host test of the compressed EEPROM image: a dictionary survives save and load,
+  a damaged image is caught by the CRC, and a crafted image with a valid CRC but a
+  back reference before the start of the data is rejected without reading the window.
+*/
+//  FLAGS: -D_PARAMS_COMPRESS
+#define EEPROM_MAX 4096
+#include <ParametersEEPROM.h>
+
+static int fails = 0;
+#define CHECK(c) do { if ( !(c) ) { printf("FAIL %s:%d %s\n", __FILE__, __LINE__, #c); fails++; } } while (0)
+
+#define SIZE  512
+#define Z     (4 + PARAMS_EXT_HDR)    // "LZT" with the terminator, then the header
+
+static void sign() {
+  uint8_t crc = 0;
+  for (int j = 0; j < SIZE - 1; j++) {
+    crc ^= EEPROM.d[j];
+    for (int i = 0; i < 8; i++) crc = ( crc & 0x80 ) ? (uint8_t)((crc << 1) ^ CRCMASK) : (uint8_t)(crc << 1);
+  }
+  EEPROM.d[SIZE - 1] = crc;
+}
+
+
+int main() {
+  Dictionary d;
+  for (int i = 0; i < 20; i++) d( String("sensor") + String(i), String("mqtt://broker.local/home/sensor/") + String(i) );
+  {
+    ParametersEEPROM p("LZT", d, 0, SIZE);
+    CHECK( p.begin() == PARAMS_OK );
+    CHECK( p.save() == PARAMS_OK );
+  }
+
+  //  the image is compressed and smaller than the raw pairs
+  CHECK( EEPROM.d[4] == (PARAMS_EXT_MARK & 0xff) && EEPROM.d[5] == (PARAMS_EXT_MARK >> 8) && EEPROM.d[6] == PARAMS_CODEC_LZ );
+  uint16_t rawLen = EEPROM.d[7] | (EEPROM.d[8] << 8);
+  uint16_t zLen = EEPROM.d[9] | (EEPROM.d[10] << 8);
+  CHECK( zLen < rawLen );
+
+  //  readers save their dictionary when destroyed: every case starts from this image
+  static uint8_t image[SIZE];
+  memcpy(image, EEPROM.d, SIZE);
+
+  //  round trip
+  {
+    Dictionary e;
+    ParametersEEPROM p("LZT", e, 0, SIZE);
+    p.begin();
+    CHECK( p.load() == PARAMS_OK );
+    CHECK( e.count() == d.count() );
+    bool same = true;
+    for (unsigned i = 0; i < d.count(); i++) same &= ( e[d(i)] == d[i] );
+    CHECK( same );
+  }
+
+  //  a damaged byte: the CRC does not match
+  memcpy(EEPROM.d, image, SIZE);
+  EEPROM.d[Z + 5] ^= 0x40;
+  {
+    Dictionary e;
+    ParametersEEPROM p("LZT", e, 0, SIZE);
+    p.begin();
+    CHECK( p.load() == PARAMS_CRC );
+    CHECK( e.count() == 0 );
+  }
+
+  //  crafted: the first item refers 256 bytes back, before anything was decoded
+  memcpy(EEPROM.d, image, SIZE);
+  EEPROM.d[Z] = 0x00;
+  EEPROM.d[Z + 1] = 0xff;
+  EEPROM.d[Z + 2] = 0x00;
+  sign();
+  {
+    Dictionary e;
+    ParametersEEPROM p("LZT", e, 0, SIZE);
+    p.begin();
+    CHECK( p.load() == PARAMS_FMT );
+    CHECK( e.count() == 0 );
+  }
+
+  //  crafted: a valid count, then a reference past the bytes decoded so far
+  memcpy(EEPROM.d, image, SIZE);
+  EEPROM.d[Z] = 0x03;         // two literals, then a reference
+  EEPROM.d[Z + 1] = 1;
+  EEPROM.d[Z + 2] = 0;
+  EEPROM.d[Z + 3] = 2;        // distance 3, two bytes decoded
+  EEPROM.d[Z + 4] = 0;
+  sign();
+  {
+    Dictionary e;
+    ParametersEEPROM p("LZT", e, 0, SIZE);
+    p.begin();
+    CHECK( p.load() == PARAMS_FMT );
+    CHECK( e.count() == 0 );
+  }
+
+  if ( fails ) return 1;
+  printf("test_compress: passed\n");
+  return 0;
+}
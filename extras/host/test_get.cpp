@@ -0,0 +1,95 @@
+/*
+  Host test of ParametersEEPROM::get(): every value of a 50-key image read straight from
+  the EEPROM matches what load() puts into the dictionary, with a linear scan, with the
+  sorted index (_PARAMS_INDEX) and with compression enabled (_PARAMS_COMPRESS). A missing
+  key, a short buffer and a zero capacity are reported; compressed images cannot be read.
+*/
+//  FLAGS:
+//  FLAGS: -D_PARAMS_INDEX
+//  FLAGS: -D_PARAMS_COMPRESS
+#define EEPROM_MAX 4096
+#include <ParametersEEPROM.h>
+#include <random>
+
+static int fails = 0;
+#define CHECK(c) do { if ( !(c) ) { printf("FAIL %s:%d %s\n", __FILE__, __LINE__, #c); fails++; } } while (0)
+
+#define KEYS  50
+#define SIZE  2048
+
+static String word(std::mt19937& aR, int aLen) {
+  String s;
+  for (int i = 0; i < aLen; i++) s.concat( (char) ('a' + aR() % 26) );
+  return s;
+}
+
+
+int main() {
+  //  random keys and values: compression does not pay off, so the raw image is stored in every build
+  std::mt19937 r(11);
+  Dictionary d;
+  while ( d.count() < KEYS ) d( word(r, 4 + r() % 8), word(r, 1 + r() % 24) );
+  {
+    ParametersEEPROM p("GET", d, 0, SIZE);
+    CHECK( p.begin() == PARAMS_OK );
+    CHECK( p.save() == PARAMS_OK );
+  }
+  bool indexed = ( EEPROM.d[4] == 0xff && EEPROM.d[5] == 0xff && EEPROM.d[6] == PARAMS_CODEC_IDX );
+#ifdef _PARAMS_INDEX
+  CHECK( indexed );
+#else
+  CHECK( !indexed );
+#endif
+
+  Dictionary e;
+  ParametersEEPROM q("GET", e, 0, SIZE);
+  q.begin();
+  CHECK( q.load() == PARAMS_OK );
+  CHECK( e.count() == KEYS );
+
+  char buf[32];
+  bool same = true;
+  for (unsigned i = 0; i < e.count(); i++) {
+    same &= ( q.get(e(i).c_str(), buf, sizeof(buf)) == PARAMS_OK );
+    same &= ( e[i] == buf );
+  }
+  CHECK( same );
+
+  CHECK( q.get("nosuchkey", buf, sizeof(buf)) == PARAMS_KEY );
+
+  //  a buffer one byte short: truncated, still terminated
+  String k = e(0);
+  String v = e[0];
+  for (unsigned i = 1; i < e.count(); i++) if ( e[i].length() > v.length() ) { k = e(i); v = e[i]; }
+  CHECK( v.length() > 2 );
+  memset(buf, 'x', sizeof(buf));
+  CHECK( q.get(k.c_str(), buf, v.length()) == PARAMS_LEN );
+  CHECK( strlen(buf) == v.length() - 1 && strncmp(buf, v.c_str(), v.length() - 1) == 0 );
+  CHECK( q.get(k.c_str(), buf, v.length() + 1) == PARAMS_OK );
+  CHECK( q.get(k.c_str(), buf, 0) == PARAMS_LEN );
+
+#ifdef _PARAMS_COMPRESS
+  //  a compressed image loads, but cannot be read a value at a time
+  {
+    Dictionary c;
+    for (int i = 0; i < KEYS; i++) c( String("sensor") + String(i), String("mqtt://broker.local/home/sensor/") + String(i) );
+    ParametersEEPROM p("LZG", c, SIZE, SIZE - 1);
+    CHECK( p.begin() == PARAMS_OK );
+    CHECK( p.save() == PARAMS_OK );
+    CHECK( p.get("sensor7", buf, sizeof(buf)) == PARAMS_FMT );
+    Dictionary f;
+    ParametersEEPROM l("LZG", f, SIZE, SIZE - 1);
+    l.begin();
+    CHECK( l.load() == PARAMS_OK );
+    CHECK( f["sensor7"] == "mqtt://broker.local/home/sensor/7" );
+  }
+#endif
+
+  if ( fails ) return 1;
+#ifdef _PARAMS_COMPRESS
+  printf("test_get: passed (scan, compression enabled)\n");
+#else
+  printf("test_get: passed (%s)\n", indexed ? "indexed" : "scan");
+#endif
+  return 0;
+}
@@ -0,0 +1,102 @@
+/*
+  Host test of the portable HMAC-SHA256 (_JSON_HMAC_SOFT): RFC 4231 test cases 1-7,
+  messages around the SHA-256 padding boundaries, and data written in pieces.
+*/
+#include <JsonConfigHmac.h>
+#include <string>
+
+static int fails = 0;
+#define CHECK(c) do { if ( !(c) ) { printf("FAIL %s:%d %s\n", __FILE__, __LINE__, #c); fails++; } } while (0)
+
+struct Vector {
+  std::string key;
+  std::string data;
+  const char* mac;
+  size_t      len;    // bytes of the MAC compared (test case 5 is truncated to 128 bits)
+};
+
+
+static std::string hex(const uint8_t* aMac, size_t aLen) {
+  static const char* d = "0123456789abcdef";
+  std::string s;
+  for (size_t i = 0; i < aLen; i++) {
+    s += d[aMac[i] >> 4];
+    s += d[aMac[i] & 15];
+  }
+  return s;
+}
+
+
+//  aStep 0: one write, otherwise pieces of aStep bytes
+static std::string mac(const std::string& aKey, const std::string& aData, size_t aStep) {
+  JsonConfigHmac h((const uint8_t*) aKey.data(), aKey.size());
+  const uint8_t* p = (const uint8_t*) aData.data();
+  size_t n = aData.size();
+  if ( aStep == 0 ) aStep = n ? n : 1;
+  for (size_t i = 0; i < n; i += aStep) h.write(p + i, std::min(aStep, n - i));
+  uint8_t m[JSON_HMAC_LEN];
+  h.finish(m);
+  return hex(m, JSON_HMAC_LEN);
+}
+
+
+int main() {
+  std::string k25;
+  for (int i = 1; i <= 25; i++) k25 += (char) i;
+
+  const Vector rfc[] = {
+    { std::string(20, '\x0b'), "Hi There", "b0344c61d8db38535ca8afceaf0bf12b881dc200c9833da726e9376c2e32cff7", 32 },
+    { "Jefe", "what do ya want for nothing?", "5bdcc146bf60754e6a042426089575c75a003f089d2739839dec58b964ec3843", 32 },
+    { std::string(20, '\xaa'), std::string(50, '\xdd'), "773ea91e36800e46854db8ebd09181a72959098b3ef8c122d9635514ced565fe", 32 },
+    { k25, std::string(50, '\xcd'), "82558a389a443c0ea4cc819899f2083a85f0faa3e578f8077a2e3ff46729665b", 32 },
+    { std::string(20, '\x0c'), "Test With Truncation", "a3b6167473100ee06e0c796c2955552b", 16 },
+    { std::string(131, '\xaa'), "Test Using Larger Than Block-Size Key - Hash Key First", "60e431591ee0b67f0d8a26aacbf5b77f8e0bc6213728c5140546040f0ee37f54", 32 },
+    { std::string(131, '\xaa'), "This is a test using a larger than block-size key and a larger than block-size data. The key needs to be hashed before being used by the HMAC algorithm.", "9b09ffa71b942fcb27635fbcd5b0e944bfdc63644f0713938a7f51535c3a35e2", 32 },
+  };
+
+  for (const Vector& v : rfc) {
+    for (size_t step : { 0, 1, 7, 64 }) {
+      std::string m = mac(v.key, v.data, step);
+      if ( m.compare(0, 2 * v.len, v.mac) != 0 ) {
+        printf("FAIL RFC 4231 case %d, step %u: %s\n", (int) (&v - rfc) + 1, (unsigned) step, m.c_str());
+        fails++;
+      }
+    }
+  }
+
+  //  lengths around the padding boundaries (55/56 bytes in the last block, full blocks)
+  const struct { size_t n; const char* mac; } pad[] = {
+    { 0,    "5d5d139563c95b5967b9bd9a8c9b233a9dedb45072794cd232dc1b74832607d0" },
+    { 55,   "5c753ac4cf15a28e7b5a045ba8ce75e02545a313f326021d770912f768fb53ef" },
+    { 56,   "e9613a403652aa5873dba8b56f223826236e87559a8d8ac63190613796d2319a" },
+    { 63,   "c5531cccae97b1a3e84ffd19fb9468e928c41d6acb9279cf4bac4aaf314196ae" },
+    { 64,   "77207571ea4243ad8e0f220679a62f9033b6d2f59f8d44517d8e9c4857b96fa0" },
+    { 119,  "4ffbedd6a1157e63e62d3fa284549bcfe39fb98dbb77ac48a89120aed5747d6b" },
+    { 120,  "d1cd515a6389be4c26cf09c03af5b128fe8fcc95992b8e2bae38bef7e54b3ef1" },
+    { 1000, "db636adca1d68c3ad2b38a24933870131c45f55262bf8f07b0c9bdc728ee5fb9" },
+  };
+  for (auto& p : pad) {
+    CHECK( mac("key", std::string(p.n, 'a'), 0) == p.mac );
+    CHECK( mac("key", std::string(p.n, 'a'), 13) == p.mac );
+  }
+
+  //  matches(): either case, exact length only, any wrong digit fails
+  {
+    JsonConfigHmac h((const uint8_t*) "Jefe", 4);
+    h.print("what do ya want for nothing?");
+    CHECK( h.matches("5BDCC146BF60754E6A042426089575C75A003F089D2739839DEC58B964EC3843") );
+  }
+  {
+    JsonConfigHmac h((const uint8_t*) "Jefe", 4);
+    h.print("what do ya want for nothing?");
+    CHECK( !h.matches("5bdcc146bf60754e6a042426089575c75a003f089d2739839dec58b964ec3844") );
+  }
+  {
+    JsonConfigHmac h((const uint8_t*) "Jefe", 4);
+    CHECK( !h.matches("5bdcc146") );
+    CHECK( !h.matches(NULL) );
+  }
+
+  printf("test_hmac: %s\n", fails ? "FAILED" : "passed");
+  return fails ? 1 : 0;
+}
@@ -0,0 +1,85 @@
+/*
+  Host test of the downloaded config cache: the whole body is cached even if parsing
+  stops early, a body shorter than its Content-Length or a failed write never
+  replaces the last good file.
+*/
+#include <JsonConfigHttp.h>
+
+static int fails = 0;
+#define CHECK(c) do { if ( !(c) ) { printf("FAIL %s:%d %s\n", __FILE__, __LINE__, #c); fails++; } } while (0)
+
+static std::string cached() {
+  std::string s;
+  FILE* f = fopen("/tmp/fsroot/cfg.json", "rb");
+  if ( !f ) return s;
+  int c;
+  while ( (c = fgetc(f)) >= 0 ) s += (char) c;
+  fclose(f);
+  return s;
+}
+
+
+struct Failing : Print {
+  size_t write(uint8_t) { return 0; }
+  size_t write(const uint8_t*, size_t) { return 0; }
+};
+
+
+int main() {
+  remove("/tmp/fsroot/cfg.json");
+  WiFi.begin("x", "y");
+  JSONConfig.cache("/cfg.json", SPIFFS);
+
+  std::string big = "{";
+  for (int i = 0; i < 40; i++) big += "\"k" + std::to_string(i) + "\":\"value" + std::to_string(i) + "\",\n";
+  big += "\"z\":\"1\"}\n";
+
+  //  parsing stops after 2 values: the cache still gets the whole body
+  ParametersDictionary d;
+  HTTPClient::body = big;
+  CHECK( JSONConfig.parse("http://x/cfg.json", d, 2) == JSON_OK );
+  CHECK( d.count() == 2 );
+  CHECK( cached() == big );
+
+  //  connection dropped before Content-Length: the last good file stays
+  HTTPClient::body = "{\"a\":\"1\"}\n";
+  HTTPClient::size = 100;
+  CHECK( JSONConfig.parse("http://x/cfg.json", d, 1) == JSON_OK );
+  CHECK( cached() == big );
+  HTTPClient::size = -2;
+
+  //  file cannot be written: the temp file is discarded, the last good file stays
+  fs::failWrites() = true;
+  CHECK( JSONConfig.parse("http://x/cfg.json", d) == JSON_OK );
+  fs::failWrites() = false;
+  CHECK( cached() == big );
+  CHECK( !SPIFFS.exists("/cfg.json.tmp") );
+
+  CHECK( JSONConfig.parse("http://x/cfg.json", d) == JSON_OK );
+  CHECK( cached() == HTTPClient::body );
+
+  //  tee reports a sink that does not take the data
+  const char b[] = "0123456789";
+  StrStream src;
+  src.s = b;
+  Failing sink;
+  JsonConfigTee tee(src, sink);
+  while ( tee.read() >= 0 );
+  tee.flush();
+  CHECK( tee.length() == 10 );
+  CHECK( tee.failed() );
+
+  //  no filesystem until cache() is called: nothing is written
+  {
+    JsonConfigHttp h;
+    ParametersDictionary e;
+    remove("/tmp/fsroot/cfg.json");
+    HTTPClient::body = "{\"a\":\"1\"}\n";
+    CHECK( h.parse("http://x/cfg.json", e) == JSON_OK );
+    CHECK( e["a"] == "1" );
+    CHECK( !SPIFFS.exists("/cfg.json") && !SPIFFS.exists("/cfg.json.tmp") );
+  }
+
+  printf("test_http_cache: %s\n", fails ? "FAILED" : "passed");
+  return fails ? 1 : 0;
+}
@@ -0,0 +1,112 @@
+/*
+  Host test of the parse limits: off by default, every limit reports its own error code,
+  and with limits set the heap taken by a parse stays bounded whatever the input.
+  Random inputs and mutations of a valid file must never crash the parser.
+*/
+#include <JsonConfig.h>
+#include <new>
+
+static int fails = 0;
+#define CHECK(c) do { if ( !(c) ) { printf("FAIL %s:%d %s\n", __FILE__, __LINE__, #c); fails++; } } while (0)
+
+//  live heap accounting through the global allocator
+static size_t live = 0, peak = 0;
+
+void* operator new(size_t n) {
+  size_t* p = (size_t*) malloc(n + sizeof(size_t));
+  if ( p == NULL ) throw std::bad_alloc();
+  *p = n;
+  live += n;
+  if ( live > peak ) peak = live;
+  return p + 1;
+}
+
+void operator delete(void* p) noexcept {
+  if ( p == NULL ) return;
+  size_t* q = (size_t*) p - 1;
+  live -= *q;
+  free(q);
+}
+
+void operator delete(void* p, size_t) noexcept { operator delete(p); }
+
+
+typedef JsonConfig<JsonConfigBufferSource, JsonConfigDictSink> Parser;
+
+//  returns the parse result, aPeak gets the heap the parse took at most
+static int8_t parse(Parser& aP, const std::string& aJson, size_t* aPeak = NULL) {
+  ParametersDictionary d;
+  size_t base = live;
+  peak = live;
+  int8_t rc = aP.parse(aJson.c_str(), aJson.size(), d);
+  if ( aPeak ) *aPeak = peak - base;
+  return rc;
+}
+
+
+int main() {
+  Parser p;
+
+  std::string longValue = "{\"a\":\"" + std::string(200000, 'v') + "\"}";
+  std::string manyKeys = "{";
+  for (int i = 0; i < 300; i++) manyKeys += "\"k" + std::to_string(i) + "\":1,";
+  manyKeys += "\"z\":1}";
+  std::string longKey = "{\"" + std::string(300, 'k') + "\":\"1\"}";
+
+  //  no limits by default: large but valid files keep parsing
+  size_t unbounded;
+  CHECK( parse(p, longValue, &unbounded) == JSON_OK );
+  CHECK( unbounded > 200000 );
+  CHECK( parse(p, manyKeys) == JSON_OK );
+  CHECK( parse(p, longKey) == JSON_OK );
+
+  //  each limit has its own error code
+  p.limits(16, 32, 8, 128);
+  CHECK( parse(p, longKey) == JSON_KEYLEN );
+  CHECK( parse(p, longValue) == JSON_VALLEN );
+  CHECK( parse(p, manyKeys) == JSON_KEYCNT );
+  std::string bytes = "{";
+  for (int i = 0; i < 6; i++) bytes += "\"k" + std::to_string(i) + "\":\"" + std::string(30, 'x') + "\",";
+  bytes += "\"z\":1}";
+  CHECK( parse(p, bytes) == JSON_SIZE );
+  CHECK( parse(p, "{\"a\":\"1\",\"b\":{\"c\":[1,2]}}") == JSON_OK );
+
+  //  heap taken by a limited parse does not depend on the input size
+  size_t bounded;
+  parse(p, longValue, &bounded);
+  CHECK( bounded < 4096 );
+
+  //  fuzz: random inputs and mutations of a valid file
+  const char alphabet[] = "{}[]\":,#\\\n abc019.-tfn";
+  const std::string seed = "{\"wifi\":{\"ssid\":\"home\",\"pwd\":\"se\\\"cret\"},\"pins\":[1,2,3],\"ota\":true,\"n\":-1.5}\n";
+  size_t worst = 0;
+  srand(1);
+  for (int i = 0; i < 200000; i++) {
+    std::string s;
+    if ( i & 1 ) {
+      int n = rand() % 80;
+      for (int j = 0; j < n; j++) s += alphabet[rand() % (sizeof(alphabet) - 1)];
+    }
+    else {
+      s = seed;
+      for (int m = rand() % 4; m >= 0; m--) {
+        size_t at = rand() % s.size();
+        switch ( rand() % 4 ) {
+          case 0: s[at] = alphabet[rand() % (sizeof(alphabet) - 1)]; break;
+          case 1: s.erase(at, 1 + rand() % 8); break;
+          case 2: s.insert(at, std::string(1 + rand() % 400, alphabet[rand() % (sizeof(alphabet) - 1)])); break;
+          case 3: s = s.substr(0, at); break;
+        }
+        if ( s.empty() ) s = "{";
+      }
+    }
+    size_t used;
+    parse(p, s, &used);
+    if ( used > worst ) worst = used;
+  }
+  printf("fuzz: 200000 inputs, worst heap per parse %u bytes\n", (unsigned) worst);
+  CHECK( worst < 4096 );
+
+  printf("test_limits: %s\n", fails ? "FAILED" : "passed");
+  return fails ? 1 : 0;
+}
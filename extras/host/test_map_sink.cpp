@@ -0,0 +1,36 @@
+/*
+  Host test of JsonConfigMapSink: values are stored up to the number of
+  entries given to parse(), and never written past the end of the map.
+*/
+#include <JsonConfigHttpMap.h>
+
+static int fails = 0;
+#define CHECK(c) do { if ( !(c) ) { printf("FAIL %s:%d %s\n", __FILE__, __LINE__, #c); fails++; } } while (0)
+
+
+int main() {
+  char s[3][16] = { "", "", "guard" };
+  char* m[3] = { s[0], s[1], s[2] };
+  JsonConfig<JsonConfigBufferSource, JsonConfigMapSink> p;
+  const char b[] = "{\"a\":\"1\",\"b\":\"two\",\"c\":\"three\"}";
+
+  //  two entries: the third value is not stored
+  CHECK( p.parse(b, sizeof(b) - 1, m, 2) == JSON_OK );
+  CHECK( strcmp(s[0], "1") == 0 && strcmp(s[1], "two") == 0 );
+  CHECK( strcmp(s[2], "guard") == 0 );
+  CHECK( p.changed() == 2 );
+
+  //  no entries: nothing is stored
+  strcpy(s[0], "old");
+  CHECK( p.parse(b, sizeof(b) - 1, m, 0) == JSON_MEM );
+  CHECK( strcmp(s[0], "old") == 0 );
+
+  //  escaped values are copied, not viewed, and bounded the same way
+  const char e[] = "{\"a\":\"x\\\"y\",\"b\":\"q\\\\\"}";
+  CHECK( p.parse(e, sizeof(e) - 1, m, 1) == JSON_OK );
+  CHECK( strcmp(s[0], "x\"y") == 0 && strcmp(s[1], "two") == 0 );
+
+  if ( fails ) return 1;
+  printf("test_map_sink: passed\n");
+  return 0;
+}
@@ -0,0 +1,81 @@
+/*
+  Host test of the _PARAMS_NOSTRING build: parsing into a map, from a buffer or a
+  Stream, and saving and loading structure-mapped parameters make no heap allocation.
+*/
+//  FLAGS: -D_PARAMS_NOSTRING
+#define EEPROM_MAX 4096
+#include <JsonConfig.h>
+#include <ParametersEEPROMMap.h>
+#include <ESP8266HTTPClient.h>
+#include <new>
+
+static int fails = 0;
+#define CHECK(c) do { if ( !(c) ) { printf("FAIL %s:%d %s\n", __FILE__, __LINE__, #c); fails++; } } while (0)
+
+//  allocations through the global allocator
+static size_t allocs = 0;
+
+void* operator new(size_t n) {
+  void* p = malloc(n ? n : 1);
+  if ( p == NULL ) throw std::bad_alloc();
+  allocs++;
+  return p;
+}
+
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+
+
+struct Config {
+  char token[5];
+  char ssid[32];
+  char pwd[32];
+  char url[64];
+};
+
+
+int main() {
+  JsonConfig<JsonConfigBufferSource, JsonConfigMapSink> p;
+  char s[3][64] = { "", "", "" };
+  char* m[3] = { s[0], s[1], s[2] };
+  //  the last value is escaped: copied through the parser's value buffer, not viewed
+  const char b[] = "{\"ssid\":\"net\",\"pwd\":\"secret\",\"url\":\"http://h/\\\"c\\\".json\"}";
+  StrStream in;
+  in.s = b;
+  size_t n;
+
+  //  map from a buffer
+  n = allocs;
+  CHECK( p.parse(b, sizeof(b) - 1, m, 3) == JSON_OK );
+  CHECK( allocs - n == 0 );
+  CHECK( strcmp(s[0], "net") == 0 && strcmp(s[2], "http://h/\"c\".json") == 0 );
+
+  //  map from a Stream
+  s[0][0] = s[1][0] = s[2][0] = 0;
+  n = allocs;
+  CHECK( p.parse(in, m, 3) == JSON_OK );
+  CHECK( allocs - n == 0 );
+  CHECK( strcmp(s[1], "secret") == 0 && strcmp(s[2], "http://h/\"c\".json") == 0 );
+
+  //  structure-mapped parameters
+  Config c = { "EBS1", "net", "secret", "http://h/c.json" };
+  Config e;
+  memset(&e, 0, sizeof(e));
+  n = allocs;
+  {
+    ParametersEEPROMMap w("EBS1", &c, NULL, 0, sizeof(Config));
+    CHECK( w.begin() == PARAMS_OK );
+    CHECK( w.save() == PARAMS_OK );
+  }
+  {
+    ParametersEEPROMMap r("EBS1", &e, NULL, 0, sizeof(Config));
+    CHECK( r.begin() == PARAMS_OK );
+    CHECK( r.load() == PARAMS_OK );
+  }
+  CHECK( allocs - n == 0 );
+  CHECK( memcmp(&c, &e, sizeof(Config)) == 0 );
+
+  if ( fails ) return 1;
+  printf("test_nostring: passed\n");
+  return 0;
+}
@@ -0,0 +1,114 @@
+/*
+  Soak test of ParametersPool (_PARAMS_POOL build): thousands of config refreshes with
+  random keys and value lengths, checked against a reference map. The pool never leaks
+  a block, and the Dictionary library is not needed by a pool build. The heap is tracked
+  through the global allocator: a refresh leaves nothing on the heap, and the temporaries
+  it takes (parser and accessor Strings) stay small, so the heap does not fragment over time.
+*/
+//  FLAGS: -D_PARAMS_POOL
+#include <JsonConfigHttp.h>
+#include <map>
+#include <random>
+#include <new>
+
+#ifdef DICTIONARY_STUB
+#error "_PARAMS_POOL build includes Dictionary.h"
+#endif
+
+static int fails = 0;
+#define CHECK(c) do { if ( !(c) ) { printf("FAIL %s:%d %s\n", __FILE__, __LINE__, #c); fails++; } } while (0)
+
+#define ENTRIES   40
+#define BLOCKS    90
+#define REFRESHES 20000
+#define REPORT    2500
+
+//  live heap accounting through the global allocator (not inlined: g++ would pair the inlined
+//  free() with the new expression of the std containers and warn)
+static size_t live = 0, peak = 0;
+
+__attribute__((noinline)) void* operator new(size_t n) {
+  size_t* p = (size_t*) malloc(n + sizeof(size_t));
+  if ( p == NULL ) throw std::bad_alloc();
+  *p = n;
+  live += n;
+  if ( live > peak ) peak = live;
+  return p + 1;
+}
+
+__attribute__((noinline)) void operator delete(void* p) noexcept {
+  if ( p == NULL ) return;
+  size_t* q = (size_t*) p - 1;
+  live -= *q;
+  free(q);
+}
+
+void operator delete(void* p, size_t) noexcept { operator delete(p); }
+
+
+int main() {
+  std::mt19937 r(7);
+  ParametersPool p(ENTRIES, BLOCKS);
+  std::map<std::string, std::string> m;
+  int bad = 0, full = 0;
+  unsigned minAvail = p.available();
+  size_t kept = 0, worst = 0, window = 0;
+
+  for (int c = 0; c < REFRESHES; c++) {
+    std::string cfg = "{";
+    std::vector<std::pair<std::string, std::string>> kv;
+    for (int i = 0; i < 30; i++) {
+      std::string k = "key" + std::to_string(r() % 35);
+      std::string v(1 + r() % 40, 'a' + r() % 26);
+      kv.push_back({k, v});
+      cfg += "\"" + k + "\":\"" + v + "\",";
+    }
+    cfg.back() = '}';
+
+    //  heap held after the refresh, and at most while it runs (an accessor included)
+    size_t base = live;
+    peak = live;
+    int8_t rc = JSONConfig.parse(cfg.c_str(), cfg.size(), p);
+    if ( p.count() ) (void) p[0u].length();
+    kept += live - base;
+    if ( peak - base > window ) window = peak - base;
+    if ( rc != JSON_OK ) {
+      //  pool full: whatever was stored is still consistent
+      full++;
+      m.clear();
+      for (unsigned i = 0; i < p.count(); i++) m[p(i).c_str()] = p[i].c_str();
+    }
+    else {
+      for (auto& x : kv) m[x.first] = x.second;
+    }
+
+    if ( p.count() != m.size() ) bad++;
+    for (auto& x : m) if ( std::string(p[x.first.c_str()].c_str()) != x.second ) bad++;
+    size_t blocks = 0;
+    for (auto& x : m) blocks += (x.first.size() + x.second.size() + 2 + PARAMS_POOL_BLOCK - 1) / PARAMS_POOL_BLOCK;
+    if ( blocks + p.available() != BLOCKS ) bad++;
+    if ( p.available() < minAvail ) minAvail = p.available();
+
+    if ( c % REPORT == REPORT - 1 ) {
+      printf("  %5d refreshes: heap kept %u bytes, largest temporary %u bytes\n", c + 1, (unsigned) kept, (unsigned) window);
+      if ( window > worst ) worst = window;
+      window = 0;
+    }
+
+    if ( c % 2500 == 0 ) {
+      p.remove(String(m.begin()->first.c_str()));
+      m.erase(m.begin());
+    }
+  }
+  printf("pool soak: %d refreshes, %d hit a full pool, lowest free %u of %u blocks\n", REFRESHES, full, minAvail, BLOCKS);
+  CHECK( bad == 0 );
+  CHECK( kept == 0 );
+  CHECK( worst < 1024 );
+
+  p.destroy();
+  CHECK( p.count() == 0 );
+  CHECK( p.available() == BLOCKS );
+
+  printf("test_pool_soak: %s\n", fails ? "FAILED" : "passed");
+  return fails ? 1 : 0;
+}
@@ -0,0 +1,92 @@
+/*
+  Host test of the ParametersEEPROM RTC copy: images are keyed by token,
+  objects sharing an area do not evict each other, and the default area
+  leaves user RTC memory on both sides of it to the sketch.
+*/
+//  FLAGS: -D_PARAMS_RTC
+#define EEPROM_MAX 4096
+#include <ParametersEEPROM.h>
+
+static int fails = 0;
+#define CHECK(c) do { if ( !(c) ) { printf("FAIL %s:%d %s\n", __FILE__, __LINE__, #c); fails++; } } while (0)
+
+static void wipeFlash() {
+  for (int i = 0; i < 4096; i++) EEPROM.d[i] = 0xff;
+}
+
+
+int main() {
+  for (int i = 0; i < 128; i++) ESP.rtc[i] = 0xA5A5A5A5UL;
+
+  Dictionary d;
+  d("ssid", "net");
+  d("pwd", "secret");
+  {
+    ParametersEEPROM p("EBS2", d, 0, 512);
+    CHECK( p.begin() == PARAMS_OK );
+    CHECK( p.save() == PARAMS_OK );
+  }
+
+  //  the sketch's part of RTC memory is left alone
+  bool untouched = true;
+  for (int i = 0; i < PARAMS_RTC_OFFSET; i++) untouched &= ( ESP.rtc[i] == 0xA5A5A5A5UL );
+  for (int i = PARAMS_RTC_OFFSET + PARAMS_RTC_SIZE / 4; i < 128; i++) untouched &= ( ESP.rtc[i] == 0xA5A5A5A5UL );
+  CHECK( untouched );
+
+  //  wake up: loaded from RTC memory even with the flash copy gone
+  wipeFlash();
+  {
+    Dictionary e;
+    ParametersEEPROM p("EBS2", e, 0, 512);
+    p.begin();
+    CHECK( p.load() == PARAMS_OK );
+    CHECK( e["pwd"] == "secret" );
+  }
+
+  //  another token sharing the area neither loads nor evicts the image
+  {
+    Dictionary o;
+    o("key", "other");
+    ParametersEEPROM p("OTHR", o, 1024, 512);
+    p.begin();
+    CHECK( p.load() != PARAMS_OK );
+    CHECK( p.save() == PARAMS_OK );
+    Dictionary e;
+    ParametersEEPROM q("EBS2", e, 0, 512);
+    q.begin();
+    CHECK( q.load() == PARAMS_OK );
+    CHECK( e["ssid"] == "net" );
+  }
+
+  //  with an area of its own the second object keeps an RTC copy as well
+  {
+    Dictionary o;
+    o("key", "other");
+    ParametersEEPROM p("OTHR", o, 1024, 512);
+    CHECK( p.rtc(PARAMS_RTC_OFFSET + PARAMS_RTC_SIZE / 4, 128) == PARAMS_OK );
+    CHECK( p.rtc(120, 64) == PARAMS_LEN );
+    p.begin();
+    CHECK( p.save() == PARAMS_OK );
+    wipeFlash();
+    Dictionary e;
+    ParametersEEPROM q("OTHR", e, 1024, 512);
+    q.rtc(PARAMS_RTC_OFFSET + PARAMS_RTC_SIZE / 4, 128);
+    q.begin();
+    CHECK( q.load() == PARAMS_OK );
+    CHECK( e["key"] == "other" );
+  }
+
+  //  corrupted image is not trusted: with the flash copy gone there is nothing to load
+  {
+    Dictionary e;
+    ParametersEEPROM p("EBS2", e, 0, 512);
+    p.begin();
+    CHECK( p.load() == PARAMS_OK );
+    ESP.rtc[PARAMS_RTC_OFFSET + PARAMS_RTC_HDR / 4] ^= 1;
+    wipeFlash();
+    CHECK( p.load() != PARAMS_OK );
+  }
+
+  printf("test_rtc: %s\n", fails ? "FAILED" : "passed");
+  return fails ? 1 : 0;
+}
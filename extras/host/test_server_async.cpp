@@ -0,0 +1,112 @@
+/*
+  Host test of the async portal backend: several clients are connected at once, their
+  /config bodies arrive in interleaved chunks, and every request is answered through
+  the real EspBootstrapServerAsync serve() and body() path.
+*/
+//  FLAGS: -D_BOOTSTRAP_ASYNC
+#define private public
+#define protected public
+#include <EspBootstrapDict.h>
+#undef private
+#undef protected
+
+static int fails = 0;
+#define CHECK(c) do { if ( !(c) ) { printf("FAIL %s:%d %s\n", __FILE__, __LINE__, #c); fails++; } } while (0)
+
+#define CLIENTS 8
+#define CHUNK   7
+
+
+int main() {
+  EspBootstrapDict& bs = EspBootstrapDict::instance();
+  ParametersDictionary d;
+  d("Title", "T");
+  d("ssid", "s");
+  d("pwd", "p");
+  bs.iDict = &d;
+  bs.iNum = 2;
+
+  //  routes as registered by run()
+  EspBootstrapServerAsync* srv = new EspBootstrapServerAsync(80);
+  bs.iServer = srv;
+  srv->on("/submit.html", __espbootstrap_dict_handlesubmit);
+  srv->onPost(BOOTSTRAP_CONFIG, __espbootstrap_dict_handleconfig);
+  srv->on(BOOTSTRAP_STATUS, __espbootstrap_dict_handlestatus);
+  srv->on(BOOTSTRAP_CSS, __espbootstrap_dict_handlecss);
+  srv->onNotFound(__espbootstrap_dict_handleroot);
+  srv->begin();
+  AsyncWebServer& w = srv->iServer;
+
+  //  even clients post a config (client 6 with an unknown key), odd ones load the page and the stylesheet
+  AsyncWebServerRequest* r[CLIENTS];
+  std::string body[CLIENTS];
+  for (int i = 0; i < CLIENTS; i++) {
+    if ( i % 2 == 0 ) {
+      body[i] = "{\"ssid\":\"net" + std::to_string(i) + "\",\"pwd\":\"secret" + std::to_string(i) + "\"" + ( i == 6 ? ",\"bad\":\"1\"" : "" ) + "}";
+      r[i] = w.accept(HTTP_POST, BOOTSTRAP_CONFIG, body[i].size());
+    }
+    else {
+      r[i] = w.accept(HTTP_GET, i % 4 == 1 ? "/" : BOOTSTRAP_CSS);
+    }
+  }
+
+  //  the TCP stack delivers the bodies a few bytes at a time, all clients in turn
+  for (size_t off = 0; ; off += CHUNK) {
+    bool more = false;
+    for (int i = 0; i < CLIENTS; i += 2) {
+      size_t n = body[i].size();
+      if ( off >= n ) continue;
+      w.receive(r[i], (const uint8_t*) body[i].data() + off, std::min((size_t) CHUNK, n - off), off, n);
+      more = true;
+    }
+    if ( !more ) break;
+  }
+
+  //  handlers run one at a time once a request is complete, last one first
+  for (int i = CLIENTS - 1; i >= 0; i--) w.complete(r[i]);
+
+  for (int i = 0; i < CLIENTS; i++) {
+    AsyncWebServerResponse* a = r[i]->response;
+    CHECK( a != NULL );
+    if ( a == NULL ) continue;
+    if ( i == 6 ) {
+      CHECK( a->code == 400 );
+    }
+    else if ( i % 2 == 0 ) {
+      CHECK( a->code == 200 );
+      CHECK( a->content.indexOf("\"count\":2") >= 0 );
+    }
+    else if ( i % 4 == 1 ) {
+      CHECK( a->code == 200 );
+      CHECK( a->content.indexOf("<form") >= 0 );
+    }
+    else {
+      CHECK( a->code == 200 );
+      CHECK( a->hdrs.size() >= 3 );   // cache control and etag queued before the response started
+    }
+  }
+  //  client 0 completed last
+  CHECK( d["ssid"] == "net0" && d["pwd"] == "secret0" );
+  CHECK( srv->iRequest == NULL );
+
+  for (int i = 0; i < CLIENTS; i++) delete r[i];
+
+  //  a body over BOOTSTRAP_MAX_BODY is neither buffered nor handed to the handler
+  {
+    std::string big = "{\"ssid\":\"" + std::string(BOOTSTRAP_MAX_BODY, 'x') + "\"}";
+    AsyncWebServerRequest* q = w.accept(HTTP_POST, BOOTSTRAP_CONFIG, big.size());
+    for (size_t off = 0; off < big.size(); off += 1024) w.receive(q, (const uint8_t*) big.data() + off, std::min((size_t) 1024, big.size() - off), off, big.size());
+    CHECK( q->_tempObject == NULL );
+    w.complete(q);
+    CHECK( q->response != NULL && q->response->code == 413 );
+    CHECK( d["ssid"] == "net0" );
+    delete q;
+  }
+
+  delete srv;
+  bs.iServer = NULL;
+
+  if ( fails ) return 1;
+  printf("test_server_async: passed\n");
+  return 0;
+}
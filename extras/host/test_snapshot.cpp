@@ -0,0 +1,89 @@
+/*
+  Multithreaded stress test of ParametersSnapshot: one writer keeps publishing new
+  generations while several readers check that every snapshot they hold is complete
+  (all fields from the same generation) and that generations never go backwards.
+*/
+#include <ParametersSnapshot.h>
+#include <Dictionary.h>
+#include <thread>
+#include <vector>
+
+#define READERS     4
+#define GENERATIONS 5000L
+#define WORDS       64
+
+struct Config {
+  uint32_t w[WORDS];
+};
+
+static std::atomic<bool>  done(false);
+static std::atomic<long>  torn(0);
+static std::atomic<long>  backwards(0);
+static std::atomic<long>  reads(0);
+
+template<class T, class F> void reader(ParametersSnapshot<T>& aSnap, F aGen) {
+  long last = 0;
+  while ( !done ) {
+    typename ParametersSnapshot<T>::Reader r(aSnap);
+    long g = aGen(*r, torn);
+    if ( g < last ) backwards++;
+    last = g;
+    reads++;
+    if ( (reads & 0xff) == 0 ) std::this_thread::yield();
+  }
+}
+
+
+static long structGen(Config& c, std::atomic<long>& aTorn) {
+  for (int i = 1; i < WORDS; i++) if ( c.w[i] != c.w[0] ) { aTorn++; break; }
+  return c.w[0];
+}
+
+
+static long dictGen(Dictionary& d, std::atomic<long>& aTorn) {
+  String a = d["a"];
+  if ( d["b"] != a || d.count() != 2 ) aTorn++;
+  return a.toInt();
+}
+
+
+template<class T, class F, class W> int run(const char* aName, F aGen, W aWrite, long aGenerations) {
+  T c1, c2;
+  aWrite(c1, 0);
+  aWrite(c2, 0);
+  ParametersSnapshot<T> snap(c1, c2);
+
+  done = false; torn = 0; backwards = 0; reads = 0;
+  std::vector<std::thread> th;
+  for (int i = 0; i < READERS; i++) th.emplace_back(reader<T, F>, std::ref(snap), aGen);
+  while ( reads < READERS ) std::this_thread::yield();
+
+  for (long g = 1; g <= aGenerations; g++) {
+    aWrite(snap.edit(), g);
+    snap.publish();
+  }
+  done = true;
+  for (auto& t : th) t.join();
+
+  typename ParametersSnapshot<T>::Reader r(snap);
+  long last = aGen(*r, torn);
+  printf("%s: %ld generations, reads %ld, torn %ld, backwards %ld\n", aName, aGenerations, (long) reads, (long) torn, (long) backwards);
+  return ( torn == 0 && backwards == 0 && last == aGenerations ) ? 0 : 1;
+}
+
+
+int main() {
+  int fails = 0;
+
+  fails += run<Config>("struct", structGen, [](Config& c, long g) {
+    for (int i = 0; i < WORDS; i++) c.w[i] = g;
+  }, GENERATIONS);
+
+  fails += run<Dictionary>("dictionary", dictGen, [](Dictionary& d, long g) {
+    d("a", String((int) g));
+    d("b", String((int) g));
+  }, GENERATIONS / 4);
+
+  printf("test_snapshot: %s\n", fails ? "FAILED" : "passed");
+  return fails ? 1 : 0;
+}
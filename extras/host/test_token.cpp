@@ -0,0 +1,45 @@
+/*
+  Host test of ParametersToken: a String token is copied, so a temporary
+  String (the usual String("EBS") + version) keeps identifying the stored
+  parameters after the temporary is gone.
+*/
+#define EEPROM_MAX 4096
+#include <ParametersEEPROM.h>
+#include <type_traits>
+
+static int fails = 0;
+#define CHECK(c) do { if ( !(c) ) { printf("FAIL %s:%d %s\n", __FILE__, __LINE__, #c); fails++; } } while (0)
+
+
+int main() {
+  static_assert( std::is_constructible<ParametersToken, String&&>::value, "temporary String token" );
+
+  Dictionary d;
+  d("ssid", "net");
+  ParametersEEPROM* p = new ParametersEEPROM(String("EBS") + String(2), d, 0, 512);
+  {
+    //  reuse the freed temporary's memory
+    String junk("XXXXXXXXXXXXXXXX");
+    CHECK( strcmp(p->token().c_str(), "EBS2") == 0 );
+  }
+  CHECK( p->token().length() == 4 );
+  CHECK( p->begin() == PARAMS_OK );
+  CHECK( p->save() == PARAMS_OK );
+  delete p;
+
+  Dictionary e;
+  ParametersEEPROM q("EBS2", e, 0, 512);
+  q.begin();
+  CHECK( q.load() == PARAMS_OK );
+  CHECK( e["ssid"] == "net" );
+
+  //  copies of a token stay valid on their own
+  ParametersToken* t = new ParametersToken(String("COPY"));
+  ParametersToken c(*t);
+  delete t;
+  CHECK( strcmp(c.c_str(), "COPY") == 0 );
+
+  if ( fails ) return 1;
+  printf("test_token: passed\n");
+  return 0;
+}
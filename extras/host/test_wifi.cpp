@@ -0,0 +1,54 @@
+/*
+  Host test of ParametersWiFi: token length check in begin() and credentials
+  recorded by the bootstrap portal once they pass the handover test.
+*/
+#define EEPROM_MAX 4096
+#include <EspBootstrapBase.h>
+
+static int fails = 0;
+#define CHECK(c) do { if ( !(c) ) { printf("FAIL %s:%d %s\n", __FILE__, __LINE__, #c); fails++; } } while (0)
+
+//  exposes the handover test steps
+class Portal : public EspBootstrapBase {
+  public:
+    Portal() { iServer = new EspBootstrapServerSync(80); };
+    void test(const char* aSsid, const char* aPwd) { startTest(aSsid, aPwd); checkTest(); };
+    uint8_t state() { return iTestState; };
+};
+
+
+int main() {
+  ParametersWiFi tooLong("WIFI_TOKEN_16_CH", 0);
+  CHECK( tooLong.begin() == PARAMS_LEN );
+
+  ParametersWiFi w("WIFI_TOKEN_15CH", 0);
+  CHECK( w.begin() == PARAMS_OK );
+  w.load();
+
+  //  not connected: nothing to remember
+  WiFi.st = 0;
+  CHECK( w.remember() == PARAMS_ERR );
+
+  Portal p;
+  p.wifi(w);
+
+  WiFi.good = "home";
+  p.test("cafe", "latte");
+  CHECK( p.state() == BOOTSTRAP_TEST_RUNNING );
+  CHECK( w.set(0).ssid[0] == 0 );
+
+  p.test("home", "secret");
+  CHECK( p.state() == BOOTSTRAP_TEST_CONNECTED );
+  CHECK( strcmp(w.set(0).ssid, "home") == 0 );
+  CHECK( strcmp(w.set(0).pwd, "secret") == 0 );
+  CHECK( w.set(0).flags & PARAMS_WIFI_BSSID );
+
+  //  the record survives a reload from EEPROM
+  ParametersWiFi r("WIFI_TOKEN_15CH", 0);
+  r.begin();
+  CHECK( r.load() == PARAMS_OK );
+  CHECK( strcmp(r.set(0).ssid, "home") == 0 );
+
+  printf("test_wifi: %s\n", fails ? "FAILED" : "passed");
+  return fails ? 1 : 0;
+}
@@ -0,0 +1,71 @@
+/*
+  Host test of ParametersWriteBehind: debounce, deadline and snapshot consistency
+  with the std::thread flusher of the host build.
+*/
+#define EEPROM_MAX 4096
+#include <ParametersEEPROM.h>
+#include <ParametersWriteBehind.h>
+
+static int fails = 0;
+#define CHECK(c) do { if ( !(c) ) { printf("FAIL %s:%d %s\n", __FILE__, __LINE__, #c); fails++; } } while (0)
+
+int main() {
+  String t("EBS2");
+  Dictionary live, shadow;
+  live("a", "0");
+  live("b", "0");
+
+  ParametersEEPROM pe(t, shadow, 0, 1024);
+  ParametersWriteBehind w(pe, live, shadow, 50, 300);
+  CHECK( w.begin() == PARAMS_OK );
+
+  //  burst of saves inside the quiet period: nothing is written until it goes quiet
+  int c0 = EEPROM.commits;
+  for (int i = 0; i < 10; i++) {
+    live("a", String(i));
+    live("b", String(i));
+    CHECK( w.save() == PARAMS_OK );
+    delay(10);
+  }
+  CHECK( EEPROM.commits == c0 );
+  CHECK( w.dirty() );
+  delay(250);
+  CHECK( EEPROM.commits == c0 + 1 );
+  CHECK( !w.dirty() );
+
+  //  continuous saves: the deadline forces writes anyway
+  c0 = EEPROM.commits;
+  for (int i = 0; i < 70; i++) {
+    live("a", String(100 + i));
+    live("b", String(100 + i));
+    w.save();
+    delay(10);
+  }
+  CHECK( EEPROM.commits > c0 );
+
+  //  the application keeps changing its dictionary while flushes run in the background:
+  //  every saved image must be one the application handed to save()
+  for (int i = 0; i < 2000; i++) {
+    live("a", String(1000 + i));
+    if ( i % 7 == 0 ) delay(1);
+    live("b", String(1000 + i));
+    if ( i % 3 == 0 ) w.save();
+  }
+  w.save();
+  CHECK( w.flush() == PARAMS_OK );
+
+  Dictionary check;
+  ParametersEEPROM pc(t, check, 0, 1024);
+  CHECK( pc.begin() == PARAMS_OK );
+  CHECK( pc.load() == PARAMS_OK );
+  CHECK( check["a"] == check["b"] );
+  CHECK( check["a"] == String(2999) );
+
+  //  load() goes through the shadow into the application's dictionary
+  live.destroy();
+  CHECK( w.load() == PARAMS_OK );
+  CHECK( live["b"] == String(2999) );
+
+  printf("test_writebehind: %s\n", fails ? "FAILED" : "passed");
+  return fails ? 1 : 0;
+}
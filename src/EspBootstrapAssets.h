@@ -0,0 +1,26 @@
+#ifndef _ESPBOOTSTRAPASSETS_H_
+#define _ESPBOOTSTRAPASSETS_H_
+
+//  Generated by extras/ebs_assets.py from extras/portal - do not edit
+
+#include <Arduino.h>
+
+//  portal.css: 287 bytes, 202 gzipped
+#define EBS_ETAG_PORTAL_CSS "\"3a082d6a\""
+static const uint8_t __ebs_portal_css_gz[] PROGMEM = {
+  0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x65, 0x8f, 0xcb, 0x0a, 0xc2, 0x30,
+  0x10, 0x45, 0xf7, 0xfd, 0x0a, 0x41, 0xdc, 0x19, 0x69, 0x8b, 0x14, 0x49, 0xf1, 0x4b, 0xa4, 0x8b,
+  0xc4, 0x4c, 0x6d, 0x20, 0x2f, 0x92, 0x29, 0x4d, 0x2d, 0xfd, 0x77, 0x53, 0x2b, 0x62, 0x71, 0x79,
+  0x0f, 0xc3, 0xbd, 0x67, 0xb8, 0x15, 0xe3, 0xd4, 0x5a, 0x83, 0xa4, 0x65, 0x5a, 0xaa, 0x91, 0x06,
+  0x66, 0x02, 0x09, 0xe0, 0x65, 0x5b, 0x6b, 0xe6, 0x1f, 0xd2, 0xd0, 0x7c, 0xc7, 0x7a, 0xb4, 0x29,
+  0x45, 0x32, 0x48, 0x81, 0x1d, 0x3d, 0x5f, 0x72, 0x17, 0x6b, 0xc7, 0x84, 0x90, 0xe6, 0x41, 0x2f,
+  0x2e, 0xce, 0x59, 0x57, 0x4e, 0x77, 0xab, 0xac, 0xa7, 0x5c, 0xf5, 0xb0, 0xc4, 0x13, 0x78, 0xff,
+  0x41, 0x1e, 0xc4, 0x9c, 0x49, 0xe3, 0x7a, 0xbc, 0xe1, 0xe8, 0xe0, 0x8a, 0x10, 0xb1, 0x39, 0xfe,
+  0x00, 0xc7, 0x42, 0x18, 0xac, 0x17, 0xcd, 0xc4, 0x6d, 0x24, 0x41, 0x3e, 0x97, 0x5a, 0x9e, 0x00,
+  0x78, 0x92, 0x48, 0xbd, 0xae, 0x16, 0x79, 0x7e, 0xf8, 0x8e, 0x56, 0x49, 0xe0, 0x6d, 0x9d, 0xae,
+  0x81, 0x16, 0xa0, 0x37, 0x0b, 0xa1, 0xe7, 0x5a, 0x62, 0x33, 0xad, 0x0f, 0x10, 0xb4, 0x8e, 0x16,
+  0xe5, 0x56, 0x79, 0x57, 0x9e, 0xff, 0x2b, 0x82, 0x66, 0x4a, 0x7d, 0xac, 0xf7, 0x55, 0x55, 0xcd,
+  0xd9, 0x0b, 0x6a, 0x2d, 0x08, 0x3a, 0x1f, 0x01, 0x00, 0x00,
+};
+
+#endif // _ESPBOOTSTRAPASSETS_H_
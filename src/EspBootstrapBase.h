@@ -35,49 +35,307 @@ POSSIBILITY OF SUCH DAMAGE.
 #include <Arduino.h>
 
 
-#if defined( ARDUINO_ARCH_ESP8266 )
-#include <ESP8266WiFi.h>
-#include <ESP8266WebServer.h>
-#define WebServer ESP8266WebServer
-#endif
-
-#if defined( ARDUINO_ARCH_ESP32 )
-#include <WiFi.h>
-#include <WebServer.h>
-#define WebServer WebServer
-#endif
+#include "EspBootstrapServer.h"
+#include "EspBootstrapAssets.h"
+#include "ParametersWiFi.h"
 
 
 #define BOOTSTRAP_OK        0
 #define BOOTSTRAP_ERR      (-1)
+#define BOOTSTRAP_FMT      (-2)
 #define BOOTSTRAP_CANCEL  (-98)
 #define BOOTSTRAP_TIMEOUT (-99)
 
 #define BOOTSTRAP_SECOND  1000L
 #define BOOTSTRAP_MINUTE  60000L
 
+#define BOOTSTRAP_CONFIG  "/config"   // bulk provisioning: POST json body here
+#define BOOTSTRAP_STATUS  "/status"   // progress of the credentials test (handover mode)
+#define BOOTSTRAP_SCAN    "/scan"     // refresh of the cached WiFi network list
+#define BOOTSTRAP_CSS     "/ebs.css"  // portal stylesheet, gzipped in PROGMEM (see EspBootstrapAssets.h)
+
+#ifndef BOOTSTRAP_CACHE_CONTROL
+#define BOOTSTRAP_CACHE_CONTROL "max-age=86400"
+#endif
+
+//  Common head of the portal pages: styling comes from the cached stylesheet
+#define BOOTSTRAP_HEAD  "<html><head><meta name=\"viewport\" content=\"width=device-width, initial-scale=1\"/><link rel=\"stylesheet\" href=\"" BOOTSTRAP_CSS "\">"
+
+#ifndef BOOTSTRAP_SCAN_MAX
+#define BOOTSTRAP_SCAN_MAX  16        // number of networks offered on the form
+#endif
+
+#ifndef BOOTSTRAP_TEST_TIMEOUT
+#define BOOTSTRAP_TEST_TIMEOUT  (20 * BOOTSTRAP_SECOND)  // time to connect with submitted credentials
+#endif
+
+#ifndef BOOTSTRAP_HANDOVER_GRACE
+#define BOOTSTRAP_HANDOVER_GRACE  (10 * BOOTSTRAP_SECOND)  // time for the browser to pick up the result
+#endif
+
+#define BOOTSTRAP_TEST_IDLE       0
+#define BOOTSTRAP_TEST_RUNNING    1
+#define BOOTSTRAP_TEST_FAILED     2
+#define BOOTSTRAP_TEST_CONNECTED  3
+
 class EspBootstrapBase {
   public:
     EspBootstrapBase();
     virtual ~EspBootstrapBase();
 
+    void              handleStatus ();
+    void              handleScan ();
+    void              handleCss ();
+    inline void       scan(bool aEnable = true) { iScanEnabled = aEnable; };
+    inline void       wifi(ParametersWiFi& aWiFi) { iWiFi = &aWiFi; };
+
   protected:
+    void              sendConfigResult(int8_t aRc, int aCount);
+    void              startTest(const char* aSsid, const char* aPwd);
+    void              checkTest();
+    void              endTest();
+    void              startScan();
+    void              checkScan();
+    void              sendScanList();
+    void              freeScan();
+    void              sendAsset(const uint8_t* aData, size_t aLen, const char* aType, const char* aEtag);
+
     int8_t            iAllDone;
-    WebServer*        iServer;
+    EspBootstrapServer* iServer;
     uint8_t           iNum;
     uint32_t          iTimeout;
+
+    bool              iHandover;
+    uint8_t           iTestState;
+    uint32_t          iTestStart;
+
+    bool              iScanEnabled;
+    bool              iScanning;
+    char*             iScanCache;   // null-separated SSIDs, strongest first
+    uint8_t           iScanCount;
+
+    ParametersWiFi*   iWiFi;        // credentials that passed the handover test are remembered here
 };
 
 
-EspBootstrapBase::EspBootstrapBase () {
+inline EspBootstrapBase::EspBootstrapBase () {
   iAllDone = false;
+  iServer = NULL;
+  iHandover = false;
+  iTestState = BOOTSTRAP_TEST_IDLE;
+  iScanEnabled = false;
+  iScanning = false;
+  iScanCache = NULL;
+  iScanCount = 0;
+  iWiFi = NULL;
+}
+
+
+//  Network list is scanned in the background and rendered from the cache,
+//  so serving the form never waits for a scan
+inline void EspBootstrapBase::startScan() {
+  if ( !iScanEnabled || iScanning ) return;
+
+  WiFi.mode(WIFI_AP_STA);  // scanning needs station interface
+  iScanning = ( WiFi.scanNetworks(true) == WIFI_SCAN_RUNNING );
+}
+
+
+inline void EspBootstrapBase::checkScan() {
+  if ( !iScanning ) return;
+
+  int16_t n = WiFi.scanComplete();
+  if ( n == WIFI_SCAN_RUNNING ) return;
+  iScanning = false;
+  if ( n <= 0 ) return;
+
+  uint8_t*  taken = (uint8_t*) calloc(n, 1);
+  uint8_t   order[BOOTSTRAP_SCAN_MAX];
+  uint8_t   cnt = 0;
+  size_t    len = 0;
+
+  if ( taken == NULL ) {
+    WiFi.scanDelete();
+    return;
+  }
+  //  strongest first, hidden networks and repeated SSIDs (several access points) skipped
+  while ( cnt < BOOTSTRAP_SCAN_MAX ) {
+    int16_t best = -1;
+    for (int16_t i = 0; i < n; i++) {
+      if ( !taken[i] && ( best < 0 || WiFi.RSSI(i) > WiFi.RSSI(best) ) ) best = i;
+    }
+    if ( best < 0 ) break;
+    taken[best] = 1;
+
+    String s = WiFi.SSID(best);
+    if ( s.length() == 0 ) continue;
+    bool dup = false;
+    for (uint8_t j = 0; j < cnt && !dup; j++) dup = ( s == WiFi.SSID(order[j]) );
+    if ( dup ) continue;
+    order[cnt++] = best;
+    len += s.length() + 1;
+  }
+  free(taken);
+
+  freeScan();
+  iScanCache = (char*) malloc(len + 1);
+  if ( iScanCache ) {
+    char* p = iScanCache;
+    for (uint8_t j = 0; j < cnt; j++) {
+      strcpy(p, WiFi.SSID(order[j]).c_str());
+      p += strlen(p) + 1;
+    }
+    iScanCount = cnt;
+  }
+  WiFi.scanDelete();
+}
+
+
+inline void EspBootstrapBase::freeScan() {
+  if ( iScanCache ) free(iScanCache);
+  iScanCache = NULL;
+  iScanCount = 0;
+}
+
+
+//  Datalist for the SSID field and a rescan link
+inline void EspBootstrapBase::sendScanList() {
+  char buf[256];
+  const char* p = iScanCache;
+
+  if ( !iScanEnabled ) return;
+
+  iServer->sendContent("<datalist id=\"ebs-ssids\">");
+  for (uint8_t j = 0; j < iScanCount; j++) {
+    char* b = buf;
+    strcpy(b, "<option value=\"");
+    b += strlen(b);
+    for ( ; *p; p++) {
+      if ( *p == '"' ) { strcpy(b, "&quot;"); b += 6; }
+      else if ( *p == '&' ) { strcpy(b, "&amp;"); b += 5; }
+      else if ( *p == '<' ) { strcpy(b, "&lt;"); b += 4; }
+      else *b++ = *p;
+    }
+    p++;
+    strcpy(b, "\">");
+    iServer->sendContent(buf);
+  }
+  iServer->sendContent("</datalist>");
+  iServer->sendContent( iScanning ? "<small>Scanning for networks...</small><br>" : "<small><a href=\"" BOOTSTRAP_SCAN "\">Refresh networks</a></small><br>" );
+}
+
+
+//  Static assets are gzipped at build time: served as-is, revalidated with ETag
+inline void EspBootstrapBase::sendAsset(const uint8_t* aData, size_t aLen, const char* aType, const char* aEtag) {
+  iServer->sendHeader("Cache-Control", BOOTSTRAP_CACHE_CONTROL);
+  iServer->sendHeader("ETag", aEtag);
+  if ( iServer->header("If-None-Match") == aEtag ) {
+    iServer->send(304, aType, "");
+    return;
+  }
+  iServer->sendHeader("Content-Encoding", "gzip");
+  iServer->send_P(200, aType, (PGM_P) aData, aLen);
+}
+
+
+inline void EspBootstrapBase::handleCss() {
+  sendAsset(__ebs_portal_css_gz, sizeof(__ebs_portal_css_gz), "text/css", EBS_ETAG_PORTAL_CSS);
+}
+
+
+inline void EspBootstrapBase::handleScan() {
+  startScan();
+  iServer->sendHeader("Location", "/");
+  iServer->send(302, "text/plain", "");
+}
+
+
+//  Handover mode: submitted credentials are tested in AP+STA mode while the portal is still up
+inline void EspBootstrapBase::startTest(const char* aSsid, const char* aPwd) {
+  WiFi.mode(WIFI_AP_STA);
+  WiFi.begin(aSsid, aPwd);
+  iTestState = BOOTSTRAP_TEST_RUNNING;
+  iTestStart = millis();
+
+  iServer->setContentLength(CONTENT_LENGTH_UNKNOWN);
+  iServer->send(200, "text/html", "" );
+  iServer->sendContent(BOOTSTRAP_HEAD "<meta http-equiv=\"refresh\" content=\"2;url=" BOOTSTRAP_STATUS "\"></head><body><h2>Connecting...</h2>");
+  iServer->sendContent("<p>Testing WiFi settings</p></body></html>");
+}
+
+
+//  Called from the portal loop
+inline void EspBootstrapBase::checkTest() {
+  if ( iTestState == BOOTSTRAP_TEST_RUNNING ) {
+    if ( WiFi.status() == WL_CONNECTED ) {
+      iTestState = BOOTSTRAP_TEST_CONNECTED;
+      iTestStart = millis();
+      if ( iWiFi ) iWiFi->remember();
+    }
+    else if ( millis() - iTestStart > BOOTSTRAP_TEST_TIMEOUT ) {
+      iTestState = BOOTSTRAP_TEST_FAILED;
+      WiFi.disconnect();
+      WiFi.mode(WIFI_AP);
+    }
+  }
+  else if ( iTestState == BOOTSTRAP_TEST_CONNECTED ) {
+    if ( millis() - iTestStart > BOOTSTRAP_HANDOVER_GRACE ) iAllDone = true;
+  }
+}
+
+
+//  Drops the access point but keeps the station connection after a successful test
+inline void EspBootstrapBase::endTest() {
+  if ( iTestState == BOOTSTRAP_TEST_CONNECTED ) {
+    WiFi.softAPdisconnect(true);
+    WiFi.mode(WIFI_STA);
+  }
+  iTestState = BOOTSTRAP_TEST_IDLE;
+}
+
+
+inline void EspBootstrapBase::handleStatus() {
+  char buf[128];
+
+  iServer->setContentLength(CONTENT_LENGTH_UNKNOWN);
+  iServer->send(200, "text/html", "" );
+  switch ( iTestState ) {
+    case BOOTSTRAP_TEST_RUNNING:
+      iServer->sendContent(BOOTSTRAP_HEAD "<meta http-equiv=\"refresh\" content=\"2\"></head><body><h2>Connecting...</h2>");
+      iServer->sendContent("<p>Testing WiFi settings</p></body></html>");
+      break;
+
+    case BOOTSTRAP_TEST_CONNECTED:
+      iServer->sendContent(BOOTSTRAP_HEAD "</head><body><h2>Connected</h2>");
+      snprintf(buf, 128, "<p>Device is connected, IP address: %s. Your changes are saved</p></body></html>", WiFi.localIP().toString().c_str());
+      iServer->sendContent(buf);
+      iAllDone = true;
+      break;
+
+    case BOOTSTRAP_TEST_FAILED:
+      iServer->sendContent(BOOTSTRAP_HEAD "</head><body><h2 class=\"err\">Failed</h2>");
+      iServer->sendContent("<p>Could not connect with these WiFi settings. <a href=\"/\">Try again</a></p></body></html>");
+      break;
+
+    default:
+      iServer->sendContent("<html><head><meta http-equiv=\"refresh\" content=\"0;url=/\"></head></html>");
+  }
+}
+
+
+//  Machine-readable result of a bulk provisioning request
+inline void EspBootstrapBase::sendConfigResult(int8_t aRc, int aCount) {
+  char buf[48];
+
+  snprintf(buf, 48, "{\"rc\":%d,\"count\":%d}", aRc, aCount);
+  iServer->send( aRc == 0 ? 200 : 400, "application/json", buf );
 }
 
 
-EspBootstrapBase::~EspBootstrapBase () {
+inline EspBootstrapBase::~EspBootstrapBase () {
+  freeScan();
   if (iServer) {
     iServer->stop();
-    iServer->close();
     delete iServer;
   }
 }
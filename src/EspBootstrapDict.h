@@ -34,17 +34,21 @@ POSSIBILITY OF SUCH DAMAGE.
 
 #include <Arduino.h>
 #include <EspBootstrapBase.h>
-#include <Dictionary.h>
+#include <ParametersPool.h>
+#include <JsonConfigBase.h>
 
 class EspBootstrapDict : public EspBootstrapBase {
   public:
     EspBootstrapDict();
     virtual ~EspBootstrapDict();
+    static EspBootstrapDict& instance();
 
-    int8_t    run(Dictionary &aDict, uint8_t aNum = 0, uint32_t aTimeout = 10 * BOOTSTRAP_MINUTE, bool aSecPass = true);
+    int8_t    run(ParametersDictionary &aDict, uint8_t aNum = 0, uint32_t aTimeout = 10 * BOOTSTRAP_MINUTE, bool aSecPass = true);
     void      handleRoot ();
     void      handleSubmit ();
+    void      handleConfig ();
     inline void cancel() { iCancelAP = true; } ;
+    inline void handover(const char* aSsidKey = "ssid", const char* aPwdKey = "pwd") { iHandover = true; iSsidKey = aSsidKey; iPwdKey = aPwdKey; };
     
 
   private:
@@ -52,31 +56,79 @@ class EspBootstrapDict : public EspBootstrapBase {
 
     bool              iCancelAP;
     bool              iSecurePassword;
-    Dictionary*       iDict;
-
+    ParametersDictionary* iDict;
+    const char*       iSsidKey;
+    const char*       iPwdKey;
+
+    //  Only keys the dictionary already has are accepted, values go to a staging dictionary
+    class ConfigParser : public JsonConfigBase {
+      public:
+        int8_t  parse(const char* aBuf, size_t aLen, ParametersDictionary* aDict, ParametersDictionary* aStage) { iDict = aDict; iStage = aStage; iCount = 0; return _doParse(aBuf, aLen, 0); };
+        int     iCount;
+      protected:
+        virtual int8_t  _storeKeyValue(const char* aKey, const char* aValue) {
+          unsigned i = 0, n = iDict->count();
+          while ( i < n && (*iDict)(i) != aKey ) i++;
+          if ( i == n ) return JSON_KEY;
+          iCount++;
+          return iStage->insert(aKey, aValue) ? JSON_MEM : JSON_OK;
+        };
+      private:
+        ParametersDictionary* iDict;
+        ParametersDictionary* iStage;
+    };
 };
 
-static EspBootstrapDict ESPBootstrap;
+#ifndef ESPBootstrap
+#define ESPBootstrap  (EspBootstrapDict::instance())
+#endif
+
+inline EspBootstrapDict::EspBootstrapDict () {
+}
+
+
+inline EspBootstrapDict::~EspBootstrapDict () {
+}
+
 
-EspBootstrapDict::EspBootstrapDict () {
+//  The shared instance: constructed on first use, one for all files of a sketch
+inline EspBootstrapDict& EspBootstrapDict::instance() {
+  static EspBootstrapDict shared;
+  return shared;
 }
 
 
-EspBootstrapDict::~EspBootstrapDict () {
+inline void __espbootstrap_dict_handleroot() {
+  EspBootstrapDict::instance().handleRoot();
 }
 
 
-void __espbootstrap_handleroot() {
-  ESPBootstrap.handleRoot();
+inline void __espbootstrap_dict_handlesubmit() {
+  EspBootstrapDict::instance().handleSubmit();
 }
 
 
-void __espbootstrap_handlesubmit() {
-  ESPBootstrap.handleSubmit();
+inline void __espbootstrap_dict_handleconfig() {
+  EspBootstrapDict::instance().handleConfig();
 }
 
 
-int8_t EspBootstrapDict::run(Dictionary &aDict, uint8_t aNum, uint32_t aTimeout, bool aSecPass) {
+inline void __espbootstrap_dict_handlestatus() {
+  EspBootstrapDict::instance().handleStatus();
+}
+
+
+inline void __espbootstrap_dict_handlescan() {
+  EspBootstrapDict::instance().handleScan();
+}
+
+
+inline void __espbootstrap_dict_handlecss() {
+  EspBootstrapDict::instance().handleCss();
+}
+
+
+inline int8_t EspBootstrapDict::run(ParametersDictionary &aDict, uint8_t aNum, uint32_t aTimeout, bool aSecPass) {
   if (aNum == 0) {
     iNum = aDict.count() - 1;
   }
@@ -95,37 +147,42 @@ int8_t EspBootstrapDict::run(Dictionary &aDict, uint8_t aNum, uint32_t aTimeout,
 }
 
 
-int8_t EspBootstrapDict::doRun() {
+inline int8_t EspBootstrapDict::doRun() {
 
-  String ssid(SSID_PREFIX);
+  char ssid[sizeof(SSID_PREFIX) + 12];
+  uint8_t mac[6];
   const IPAddress   APIP   (10, 1, 1, 1);
   const IPAddress   APMASK (255, 255, 255, 0);
 
   WiFi.disconnect();
   WiFi.mode(WIFI_AP);
+  startScan();  // before the AP is up: station scan hops channels
 
-  ssid += WiFi.macAddress();
-  ssid.replace(":", "");
-  ssid.toLowerCase();
+  WiFi.macAddress(mac);
+  snprintf(ssid, sizeof(ssid), SSID_PREFIX "%02x%02x%02x%02x%02x%02x", mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
 //#if defined( ARDUINO_ARCH_ESP8266 )
 //  ssid += String(ESP.getChipId(), HEX);
 //#endif
 #if defined( ARDUINO_ARCH_ESP32 )
 //  ssid += String((uint32_t)( ESP.getEfuseMac() & 0xFFFFFFFFL ), HEX);
-  WiFi.softAP( ssid.c_str());
+  WiFi.softAP(ssid);
   delay(50);
 #endif
 
   WiFi.softAPConfig(APIP, APIP, APMASK);
   delay(50);
-  WiFi.softAP( ssid.c_str());
+  WiFi.softAP(ssid);
   yield();
 
-  iServer = new WebServer(80);
+  iServer = new EspBootstrapServerDefault(80);
   if (iServer == NULL) return BOOTSTRAP_ERR;
 
-  iServer->on("/submit.html", __espbootstrap_handlesubmit);
-  iServer->onNotFound(__espbootstrap_handleroot);
+  iServer->on("/submit.html", __espbootstrap_dict_handlesubmit);
+  iServer->onPost(BOOTSTRAP_CONFIG, __espbootstrap_dict_handleconfig);
+  iServer->on(BOOTSTRAP_STATUS, __espbootstrap_dict_handlestatus);
+  iServer->on(BOOTSTRAP_SCAN, __espbootstrap_dict_handlescan);
+  iServer->on(BOOTSTRAP_CSS, __espbootstrap_dict_handlecss);
+  iServer->onNotFound(__espbootstrap_dict_handleroot);
 
   iAllDone = false;
   iServer->begin();
@@ -133,9 +190,14 @@ int8_t EspBootstrapDict::doRun() {
   uint32_t timeNow = millis();
   while (!iAllDone && !iCancelAP) {
     iServer->handleClient();
+    iServer->lock();
+    checkTest();
+    checkScan();
+    iServer->unlock();
     if ( millis() - timeNow > iTimeout ) {
         iServer->stop();
-        iServer->close();
+        endTest();
+        freeScan();
         delete iServer;
         iServer = NULL;
         return BOOTSTRAP_TIMEOUT;
@@ -145,7 +207,8 @@ int8_t EspBootstrapDict::doRun() {
   }
 
   iServer->stop();
-  iServer->close();
+  endTest();
+  freeScan();
   delete iServer;
   iServer = NULL;
   return (iCancelAP ? BOOTSTRAP_CANCEL: BOOTSTRAP_OK);
@@ -153,15 +216,15 @@ int8_t EspBootstrapDict::doRun() {
 
 
 #define BUFLEN 256
-void EspBootstrapDict::handleRoot() {
+inline void EspBootstrapDict::handleRoot() {
   char buf[BUFLEN];
 
   iServer->setContentLength(CONTENT_LENGTH_UNKNOWN);
   iServer->send(200, "text/html", "" );
-  iServer->sendContent("<html><head><meta name=\"viewport\" content=\"width=device-width, initial-scale=1\"/></head><body>");
+  iServer->sendContent(BOOTSTRAP_HEAD "</head><body>");
 
-  Dictionary& d = *iDict;
-  snprintf(buf, BUFLEN, "<h2 style=\"color:blue;\">%s</h2><form action=\"/submit.html\">", d[0].c_str() );
+  ParametersDictionary& d = *iDict;
+  snprintf(buf, BUFLEN, "<h2>%s</h2><form action=\"/submit.html\">", d[0].c_str() );
   iServer->sendContent(buf);
 
   for (int i = 1; i <= iNum; i++) {
@@ -171,25 +234,48 @@ void EspBootstrapDict::handleRoot() {
       snprintf(buf, BUFLEN, "<label for=\"par%02d\"><b>%s:</b></label><br><input type=\"password\" id=\"par%02d\" name=\"par%02d\" value=\"%s\"><br>", i, d(i).c_str(), i, i, d[i].c_str() );
     }
     else {
-      snprintf(buf, BUFLEN, "<label for=\"par%02d\"><b>%s:</b></label><br><input type=\"text\" id=\"par%02d\" name=\"par%02d\" value=\"%s\"><br>", i, d(i).c_str(), i, i, d[i].c_str() );
+      snprintf(buf, BUFLEN, "<label for=\"par%02d\"><b>%s:</b></label><br><input type=\"text\" id=\"par%02d\" name=\"par%02d\" value=\"%s\"%s><br>", i, d(i).c_str(), i, i, d[i].c_str(), (iScanEnabled && s.indexOf("SSID") >= 0) ? " list=\"ebs-ssids\"" : "" );
     }
     iServer->sendContent(buf);
   }
+  sendScanList();
   iServer->sendContent("<br><input type=\"submit\" value=\"Submit\"></form></body></html>");
 }
 
 
-void EspBootstrapDict::handleSubmit() {
+inline void EspBootstrapDict::handleSubmit() {
+  ParametersDictionary& d = *iDict;
+  for (int i = 0; i < iServer->args() && i < iNum; i++) {
+    d( d(i + 1), iServer->arg(i) );
+  }
+  if ( iHandover ) {
+    startTest( d[iSsidKey].c_str(), d[iPwdKey].c_str() );
+    return;
+  }
+
   iServer->setContentLength(CONTENT_LENGTH_UNKNOWN);
   iServer->send(200, "text/html", "" );
-  iServer->sendContent("<html><head><meta name=\"viewport\" content=\"width=device-width, initial-scale=1\"/></head><body><h2 style=\"color:blue;\">Saved</h2>");
+  iServer->sendContent(BOOTSTRAP_HEAD "</head><body><h2>Saved</h2>");
   iServer->sendContent("<p>Your changes are saved</p></body></html>");
+  iAllDone = true;
+}
 
-  Dictionary& d = *iDict;
-  for (int i = 0; i < iServer->args() && i < iNum; i++) {
-    d( d(i + 1), iServer->arg(i) );
+
+//  Bulk provisioning: request body in JsonConfig format is staged, and applied only if it parsed completely.
+//  Handlers run on the loop stack (4K on ESP8266), so the parser is static and reused
+inline void EspBootstrapDict::handleConfig() {
+  static ConfigParser parser;
+  ParametersDictionary stage;
+
+  if ( !iServer->hasArg("plain") ) {
+    sendConfigResult(BOOTSTRAP_FMT, 0);
+    return;
   }
-  iAllDone = true;
+  const String& body = iServer->arg("plain");
+  int8_t rc = parser.parse(body.c_str(), body.length(), iDict, &stage);
+  if ( rc == JSON_OK && iDict->merge(stage) ) rc = JSON_MEM;
+  sendConfigResult(rc, parser.iCount);
+  if ( rc == JSON_OK ) iAllDone = true;
 }
 
 
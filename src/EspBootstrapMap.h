@@ -34,17 +34,21 @@ POSSIBILITY OF SUCH DAMAGE.
 
 #include <Arduino.h>
 #include <EspBootstrapBase.h>
+#include <JsonConfigBase.h>
 
 
 class EspBootstrapMap : public EspBootstrapBase {
   public:
     EspBootstrapMap();
     virtual ~EspBootstrapMap();
+    static EspBootstrapMap& instance();
 
     int8_t    run(const char** aTitles, char** aMap, uint8_t aNum, uint32_t aTimeout = 10 * BOOTSTRAP_MINUTE, bool aSecPass = true);
     void      handleRoot ();
     void      handleSubmit ();
+    void      handleConfig ();
     inline void cancel() { iCancelAP = true; } ;
+    inline void handover(uint8_t aSsidIndex, uint8_t aPwdIndex) { iHandover = true; iSsidIndex = aSsidIndex; iPwdIndex = aPwdIndex; };
 
 
   private:
@@ -54,30 +58,80 @@ class EspBootstrapMap : public EspBootstrapBase {
     bool              iSecurePassword;
     const char**      iTitles;
     char**            iMap;
+    uint8_t           iSsidIndex;
+    uint8_t           iPwdIndex;
+
+    //  Keys are matched against the titles of the form fields, values go to a staging copy of the map
+    class ConfigParser : public JsonConfigBase {
+      public:
+        int8_t  parse(const char* aBuf, size_t aLen, const char** aTitles, String* aStage, uint8_t aNum) { iTitles = aTitles; iStage = aStage; iNum = aNum; iCount = 0; return _doParse(aBuf, aLen, 0); };
+        int     iCount;
+      protected:
+        virtual int8_t  _storeKeyValue(const char* aKey, const char* aValue) {
+          uint8_t i = 0;
+          while ( i < iNum && strcmp(iTitles[i + 1], aKey) != 0 ) i++;
+          if ( i == iNum ) return JSON_KEY;
+          iCount++;
+          iStage[i] = aValue;
+          return JSON_OK;
+        };
+      private:
+        const char**    iTitles;
+        String*         iStage;
+        uint8_t         iNum;
+    };
 };
 
 
-EspBootstrapMap::EspBootstrapMap () {
+inline EspBootstrapMap::EspBootstrapMap () {
     iCancelAP = false;
 }
 
 
-EspBootstrapMap::~EspBootstrapMap () {
+inline EspBootstrapMap::~EspBootstrapMap () {
 }
 
-static EspBootstrapMap ESPBootstrap;
 
-void __espbootstrap_handleroot() {
-  ESPBootstrap.handleRoot();
+inline EspBootstrapMap& EspBootstrapMap::instance() {
+  static EspBootstrapMap shared;
+  return shared;
+}
+
+#ifndef ESPBootstrap
+#define ESPBootstrap  (EspBootstrapMap::instance())
+#endif
+
+inline void __espbootstrap_map_handleroot() {
+  EspBootstrapMap::instance().handleRoot();
+}
+
+
+inline void __espbootstrap_map_handlesubmit() {
+  EspBootstrapMap::instance().handleSubmit();
+}
+
+
+inline void __espbootstrap_map_handleconfig() {
+  EspBootstrapMap::instance().handleConfig();
+}
+
+
+inline void __espbootstrap_map_handlestatus() {
+  EspBootstrapMap::instance().handleStatus();
+}
+
+
+inline void __espbootstrap_map_handlescan() {
+  EspBootstrapMap::instance().handleScan();
 }
 
 
-void __espbootstrap_handlesubmit() {
-  ESPBootstrap.handleSubmit();
+inline void __espbootstrap_map_handlecss() {
+  EspBootstrapMap::instance().handleCss();
 }
 
 
-int8_t EspBootstrapMap::run(const char** aTitles, char** aMap, uint8_t aNum, uint32_t aTimeout, bool aSecPass) {
+inline int8_t EspBootstrapMap::run(const char** aTitles, char** aMap, uint8_t aNum, uint32_t aTimeout, bool aSecPass) {
 
   iNum = aNum;
   iTitles = aTitles;
@@ -90,37 +144,42 @@ int8_t EspBootstrapMap::run(const char** aTitles, char** aMap, uint8_t aNum, uin
 }
 
 
-int8_t EspBootstrapMap::doRun() {
+inline int8_t EspBootstrapMap::doRun() {
 
-  String ssid(SSID_PREFIX);
+  char ssid[sizeof(SSID_PREFIX) + 12];
+  uint8_t mac[6];
   const IPAddress   APIP   (10, 1, 1, 1);
   const IPAddress   APMASK (255, 255, 255, 0);
 
   WiFi.disconnect();
   WiFi.mode(WIFI_AP);
+  startScan();  // before the AP is up: station scan hops channels
 
-  ssid += WiFi.macAddress();
-  ssid.replace(":", "");
-  ssid.toLowerCase();
+  WiFi.macAddress(mac);
+  snprintf(ssid, sizeof(ssid), SSID_PREFIX "%02x%02x%02x%02x%02x%02x", mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
 //#if defined( ARDUINO_ARCH_ESP8266 )
 //  ssid += String(ESP.getChipId(), HEX);
 //#endif
 #if defined( ARDUINO_ARCH_ESP32 )
 //  ssid += String((uint32_t)( ESP.getEfuseMac() & 0xFFFFFFFFL ), HEX);
-  WiFi.softAP( ssid.c_str());
+  WiFi.softAP(ssid);
   delay(50);
 #endif
 
   WiFi.softAPConfig(APIP, APIP, APMASK);
   delay(50);
-  WiFi.softAP( ssid.c_str());
+  WiFi.softAP(ssid);
   yield();
 
-  iServer = new WebServer(80);
+  iServer = new EspBootstrapServerDefault(80);
   if (iServer == NULL) return BOOTSTRAP_ERR;
 
-  iServer->on("/submit.html", __espbootstrap_handlesubmit);
-  iServer->onNotFound(__espbootstrap_handleroot);
+  iServer->on("/submit.html", __espbootstrap_map_handlesubmit);
+  iServer->onPost(BOOTSTRAP_CONFIG, __espbootstrap_map_handleconfig);
+  iServer->on(BOOTSTRAP_STATUS, __espbootstrap_map_handlestatus);
+  iServer->on(BOOTSTRAP_SCAN, __espbootstrap_map_handlescan);
+  iServer->on(BOOTSTRAP_CSS, __espbootstrap_map_handlecss);
+  iServer->onNotFound(__espbootstrap_map_handleroot);
 
   iAllDone = false;
   iServer->begin();
@@ -128,9 +187,14 @@ int8_t EspBootstrapMap::doRun() {
   uint32_t timeNow = millis();
   while (!iAllDone && !iCancelAP) {
     iServer->handleClient();
+    iServer->lock();
+    checkTest();
+    checkScan();
+    iServer->unlock();
     if ( millis() - timeNow > iTimeout ) {
         iServer->stop();
-        iServer->close();
+        endTest();
+        freeScan();
         delete iServer;
         iServer = NULL;
         return BOOTSTRAP_TIMEOUT;
@@ -140,7 +204,8 @@ int8_t EspBootstrapMap::doRun() {
   }
 
   iServer->stop();
-  iServer->close();
+  endTest();
+  freeScan();
   delete iServer;
   iServer = NULL;
   return (iCancelAP ? BOOTSTRAP_CANCEL: BOOTSTRAP_OK);
@@ -148,39 +213,73 @@ int8_t EspBootstrapMap::doRun() {
 
 
 #define BUFLEN 256
-void EspBootstrapMap::handleRoot() {
+inline void EspBootstrapMap::handleRoot() {
   char buf[BUFLEN];
 
   iServer->setContentLength(CONTENT_LENGTH_UNKNOWN);
   iServer->send(200, "text/html", "" );
-  iServer->sendContent("<html><head><meta name=\"viewport\" content=\"width=device-width, initial-scale=1\"/></head><body>");
+  iServer->sendContent(BOOTSTRAP_HEAD "</head><body>");
 
-  snprintf(buf, BUFLEN, "<h2 style=\"color:blue;\">%s</h2><form action=\"/submit.html\">", iTitles[0] );
+  snprintf(buf, BUFLEN, "<h2>%s</h2><form action=\"/submit.html\">", iTitles[0] );
   iServer->sendContent(buf);
 
   for (int i = 1; i <= iNum; i++) {
+    String s(iTitles[i]);
+    s.toUpperCase();
     if ( iSecurePassword && false ) { //  fr future use
       snprintf(buf, BUFLEN, "<label for=\"par%02d\"><b>%s:</b></label><br><input type=\"password\" id=\"par%02d\" name=\"par%02d\" value=\"%s\"><br>", i, iTitles[i], i, i, iMap[i - 1] );
     }
     else {
-      snprintf(buf, BUFLEN, "<label for=\"par%02d\"><b>%s:</b></label><br><input type=\"text\" id=\"par%02d\" name=\"par%02d\" value=\"%s\"><br>", i, iTitles[i], i, i, iMap[i - 1] );
+      snprintf(buf, BUFLEN, "<label for=\"par%02d\"><b>%s:</b></label><br><input type=\"text\" id=\"par%02d\" name=\"par%02d\" value=\"%s\"%s><br>", i, iTitles[i], i, i, iMap[i - 1], (iScanEnabled && s.indexOf("SSID") >= 0) ? " list=\"ebs-ssids\"" : "" );
     }
     iServer->sendContent(buf);
   }
+  sendScanList();
   iServer->sendContent("<br><input type=\"submit\" value=\"Submit\"></form></body></html>");
 }
 
 
-void EspBootstrapMap::handleSubmit() {
+inline void EspBootstrapMap::handleSubmit() {
+  for (int i = 0; i < iServer->args() && i < iNum; i++) {
+    strcpy( iMap[i], iServer->arg(i).c_str() );
+  }
+  if ( iHandover ) {
+    startTest( iMap[iSsidIndex], iMap[iPwdIndex] );
+    return;
+  }
+
   iServer->setContentLength(CONTENT_LENGTH_UNKNOWN);
   iServer->send(200, "text/html", "" );
-  iServer->sendContent("<html><head><meta name=\"viewport\" content=\"width=device-width, initial-scale=1\"/></head><body><h2 style=\"color:blue;\">Saved</h2>");
+  iServer->sendContent(BOOTSTRAP_HEAD "</head><body><h2>Saved</h2>");
   iServer->sendContent("<p>Your changes are saved</p></body></html>");
+  iAllDone = true;
+}
 
-  for (int i = 0; i < iServer->args() && i < iNum; i++) {
-    strcpy( iMap[i], iServer->arg(i).c_str() );
+
+//  Bulk provisioning: request body in JsonConfig format is staged, and applied only if it parsed completely.
+//  Handlers run on the loop stack (4K on ESP8266), so the parser is static and reused
+inline void EspBootstrapMap::handleConfig() {
+  static ConfigParser parser;
+
+  if ( !iServer->hasArg("plain") ) {
+    sendConfigResult(BOOTSTRAP_FMT, 0);
+    return;
   }
-  iAllDone = true;
+  const String& body = iServer->arg("plain");
+  String* stage = new String[iNum];
+  if ( stage == NULL ) {
+    sendConfigResult(JSON_MEM, 0);
+    return;
+  }
+  for (uint8_t i = 0; i < iNum; i++) stage[i] = iMap[i];
+
+  int8_t rc = parser.parse(body.c_str(), body.length(), iTitles, stage, iNum);
+  if ( rc == JSON_OK ) {
+    for (uint8_t i = 0; i < iNum; i++) strcpy( iMap[i], stage[i].c_str() );
+  }
+  delete[] stage;
+  sendConfigResult(rc, parser.iCount);
+  if ( rc == JSON_OK ) iAllDone = true;
 }
 
 
@@ -0,0 +1,330 @@
+#ifndef _ESPBOOTSTRAPSERVER_H_
+#define _ESPBOOTSTRAPSERVER_H_
+
+/*
+  Copyright (c) 2015-2020, Anatoli Arkhipenko.
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without modification,
+  are permitted provided that the following conditions are met:
+
+  1. Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+
+  2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+  3. Neither the name of the copyright holder nor the names of its contributors
+   may be used to endorse or promote products derived from this software without
+   specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+  OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <Arduino.h>
+
+#if defined( ARDUINO_ARCH_ESP8266 )
+#include <ESP8266WiFi.h>
+#endif
+
+#if defined( ARDUINO_ARCH_ESP32 )
+#include <WiFi.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#endif
+
+#if defined( _BOOTSTRAP_ASYNC )
+#include <ESPAsyncWebServer.h>
+#else
+#if defined( ARDUINO_ARCH_ESP8266 )
+#include <ESP8266WebServer.h>
+#define WebServer ESP8266WebServer
+#endif
+#if defined( ARDUINO_ARCH_ESP32 )
+#include <WebServer.h>
+#endif
+#endif
+
+#ifndef CONTENT_LENGTH_UNKNOWN
+#define CONTENT_LENGTH_UNKNOWN ((size_t) -1)
+#endif
+
+#ifndef BOOTSTRAP_ASYNC_HEADERS
+#define BOOTSTRAP_ASYNC_HEADERS  4    // response headers queued before the response is started
+#endif
+
+#ifndef BOOTSTRAP_MAX_BODY
+#define BOOTSTRAP_MAX_BODY  4096      // largest request body buffered by the async backend, larger ones get 413
+#endif
+
+typedef void (*EspBootstrapHandler)();
+
+//  Web server backend of the bootstrap portal.
+//  Handlers are plain functions, which get the current request and send the response
+//  through the backend, the same way they would do with the synchronous WebServer.
+class EspBootstrapServer {
+  public:
+    virtual ~EspBootstrapServer() {};
+
+    virtual void    begin() = 0;
+    virtual void    handleClient() = 0;
+    virtual void    stop() = 0;
+    virtual void    on(const char* aUri, EspBootstrapHandler aHandler) = 0;
+    virtual void    onPost(const char* aUri, EspBootstrapHandler aHandler) = 0;
+    virtual void    onNotFound(EspBootstrapHandler aHandler) = 0;
+
+    virtual int     args() = 0;
+    virtual String  arg(int aIndex) = 0;
+    virtual String  arg(const char* aName) = 0;
+    virtual bool    hasArg(const char* aName) = 0;
+    virtual String  header(const char* aName) = 0;
+
+    virtual void    setContentLength(size_t aLen) = 0;
+    virtual void    sendHeader(const char* aName, const char* aValue) = 0;
+    virtual void    send(int aCode, const char* aType, const String& aContent) = 0;
+    virtual void    send_P(int aCode, const char* aType, PGM_P aData, size_t aLen) = 0;
+    virtual void    sendContent(const char* aContent) = 0;
+    inline void     sendContent(const String& aContent) { sendContent(aContent.c_str()); };
+
+    //  Handlers and the portal loop exclude each other (async backend on ESP32)
+    virtual void    lock() {};
+    virtual void    unlock() {};
+};
+
+
+#if !defined( _BOOTSTRAP_ASYNC )
+
+//  Synchronous backend: one client at a time, served from handleClient()
+class EspBootstrapServerSync : public EspBootstrapServer {
+  public:
+    EspBootstrapServerSync(uint16_t aPort) : iServer(aPort) {};
+
+    void    begin() {
+      const char* hdrs[] = { "If-None-Match" };
+      iServer.collectHeaders(hdrs, 1);
+      iServer.begin();
+    };
+    void    handleClient() { iServer.handleClient(); };
+    void    stop() { iServer.stop(); iServer.close(); };
+    void    on(const char* aUri, EspBootstrapHandler aHandler) { iServer.on(aUri, aHandler); };
+    void    onPost(const char* aUri, EspBootstrapHandler aHandler) { iServer.on(aUri, HTTP_POST, aHandler); };
+    void    onNotFound(EspBootstrapHandler aHandler) { iServer.onNotFound(aHandler); };
+
+    int     args() { return iServer.args(); };
+    String  arg(int aIndex) { return iServer.arg(aIndex); };
+    String  arg(const char* aName) { return iServer.arg(aName); };
+    bool    hasArg(const char* aName) { return iServer.hasArg(aName); };
+    String  header(const char* aName) { return iServer.header(aName); };
+
+    void    setContentLength(size_t aLen) { iServer.setContentLength(aLen); };
+    void    sendHeader(const char* aName, const char* aValue) { iServer.sendHeader(aName, aValue); };
+    void    send(int aCode, const char* aType, const String& aContent) { iServer.send(aCode, aType, aContent); };
+    void    send_P(int aCode, const char* aType, PGM_P aData, size_t aLen) { iServer.send_P(aCode, aType, aData, aLen); };
+    void    sendContent(const char* aContent) { iServer.sendContent(aContent); };
+
+  private:
+    WebServer iServer;
+};
+
+typedef EspBootstrapServerSync EspBootstrapServerDefault;
+
+#else
+
+//  Event driven backend (ESPAsyncWebServer): connections are accepted and parsed
+//  concurrently by the TCP stack, so a slow or idle client does not hold up the others.
+//  Handlers run in the async context; the response is collected and sent when the handler returns.
+class EspBootstrapServerAsync : public EspBootstrapServer {
+  public:
+    EspBootstrapServerAsync(uint16_t aPort);
+    virtual ~EspBootstrapServerAsync();
+
+    void    begin() { iServer.begin(); };
+    void    handleClient() {};
+    void    stop() { lock(); iServer.end(); unlock(); };
+    void    on(const char* aUri, EspBootstrapHandler aHandler);
+    void    onPost(const char* aUri, EspBootstrapHandler aHandler);
+    void    onNotFound(EspBootstrapHandler aHandler);
+
+    int     args() { return iRequest->args(); };
+    String  arg(int aIndex) { return iRequest->arg((size_t) aIndex); };
+    String  arg(const char* aName);
+    bool    hasArg(const char* aName);
+    String  header(const char* aName);
+
+    void    setContentLength(size_t aLen) {};
+    void    sendHeader(const char* aName, const char* aValue);
+    void    send(int aCode, const char* aType, const String& aContent);
+    void    send_P(int aCode, const char* aType, PGM_P aData, size_t aLen);
+    void    sendContent(const char* aContent) { if ( iStream ) iStream->print(aContent); };
+
+    void    lock();
+    void    unlock();
+
+  private:
+    void    serve(AsyncWebServerRequest* aRequest, EspBootstrapHandler aHandler);
+    void    start(AsyncWebServerResponse* aResponse);
+    static void body(AsyncWebServerRequest* aRequest, uint8_t* aData, size_t aLen, size_t aIndex, size_t aTotal);
+
+    AsyncWebServer          iServer;
+    AsyncWebServerRequest*  iRequest;
+    AsyncWebServerResponse* iResponse;
+    AsyncResponseStream*    iStream;
+    String                  iHdrName[BOOTSTRAP_ASYNC_HEADERS];
+    String                  iHdrValue[BOOTSTRAP_ASYNC_HEADERS];
+    uint8_t                 iHdrCount;
+#if defined( ARDUINO_ARCH_ESP32 )
+    SemaphoreHandle_t       iMutex;
+#endif
+};
+
+typedef EspBootstrapServerAsync EspBootstrapServerDefault;
+
+
+inline EspBootstrapServerAsync::EspBootstrapServerAsync(uint16_t aPort) : iServer(aPort) {
+  iRequest = NULL;
+  iResponse = NULL;
+  iStream = NULL;
+  iHdrCount = 0;
+#if defined( ARDUINO_ARCH_ESP32 )
+  iMutex = xSemaphoreCreateMutex();
+#endif
+}
+
+
+inline EspBootstrapServerAsync::~EspBootstrapServerAsync() {
+#if defined( ARDUINO_ARCH_ESP32 )
+  if ( iMutex ) vSemaphoreDelete(iMutex);
+#endif
+}
+
+
+//  On ESP8266 async callbacks never preempt the loop, so no locking is needed there
+inline void EspBootstrapServerAsync::lock() {
+#if defined( ARDUINO_ARCH_ESP32 )
+  if ( iMutex ) xSemaphoreTake(iMutex, portMAX_DELAY);
+#endif
+}
+
+
+inline void EspBootstrapServerAsync::unlock() {
+#if defined( ARDUINO_ARCH_ESP32 )
+  if ( iMutex ) xSemaphoreGive(iMutex);
+#endif
+}
+
+
+inline void EspBootstrapServerAsync::on(const char* aUri, EspBootstrapHandler aHandler) {
+  iServer.on(aUri, HTTP_ANY, [this, aHandler](AsyncWebServerRequest* r) { serve(r, aHandler); });
+}
+
+
+//  Request body is collected into the request's temp object, and is available as arg("plain")
+inline void EspBootstrapServerAsync::onPost(const char* aUri, EspBootstrapHandler aHandler) {
+  iServer.on(aUri, HTTP_POST, [this, aHandler](AsyncWebServerRequest* r) { serve(r, aHandler); }, NULL, body);
+}
+
+
+inline void EspBootstrapServerAsync::onNotFound(EspBootstrapHandler aHandler) {
+  iServer.onNotFound([this, aHandler](AsyncWebServerRequest* r) { serve(r, aHandler); });
+}
+
+
+//  The body size comes from the client: it is checked before anything is allocated
+inline void EspBootstrapServerAsync::body(AsyncWebServerRequest* aRequest, uint8_t* aData, size_t aLen, size_t aIndex, size_t aTotal) {
+  if ( aTotal > BOOTSTRAP_MAX_BODY ) return;
+  if ( aIndex == 0 ) {
+    aRequest->_tempObject = malloc(aTotal + 1);  // freed by the request
+  }
+  char* buf = (char*) aRequest->_tempObject;
+  if ( buf == NULL || aIndex + aLen > aTotal ) return;
+  memcpy(buf + aIndex, aData, aLen);
+  if ( aIndex + aLen == aTotal ) buf[aTotal] = 0;
+}
+
+
+inline void EspBootstrapServerAsync::serve(AsyncWebServerRequest* aRequest, EspBootstrapHandler aHandler) {
+  if ( aRequest->contentLength() > BOOTSTRAP_MAX_BODY ) {
+    aRequest->send(413);
+    return;
+  }
+  lock();
+  iRequest = aRequest;
+  iResponse = NULL;
+  iStream = NULL;
+  iHdrCount = 0;
+
+  aHandler();
+
+  if ( iResponse ) iRequest->send(iResponse);
+  else iRequest->send(500);
+  iRequest = NULL;
+  unlock();
+}
+
+
+inline String EspBootstrapServerAsync::arg(const char* aName) {
+  if ( strcmp(aName, "plain") == 0 ) {
+    return String( iRequest->_tempObject ? (const char*) iRequest->_tempObject : "" );
+  }
+  return iRequest->arg(aName);
+}
+
+
+inline bool EspBootstrapServerAsync::hasArg(const char* aName) {
+  if ( strcmp(aName, "plain") == 0 ) return ( iRequest->_tempObject != NULL );
+  return iRequest->hasArg(aName);
+}
+
+
+inline String EspBootstrapServerAsync::header(const char* aName) {
+  AsyncWebHeader* h = iRequest->getHeader(aName);
+  return ( h ? h->value() : String() );
+}
+
+
+inline void EspBootstrapServerAsync::sendHeader(const char* aName, const char* aValue) {
+  if ( iResponse ) {
+    iResponse->addHeader(aName, aValue);
+  }
+  else if ( iHdrCount < BOOTSTRAP_ASYNC_HEADERS ) {
+    iHdrName[iHdrCount] = aName;
+    iHdrValue[iHdrCount] = aValue;
+    iHdrCount++;
+  }
+}
+
+
+inline void EspBootstrapServerAsync::start(AsyncWebServerResponse* aResponse) {
+  iResponse = aResponse;
+  for (uint8_t i = 0; i < iHdrCount; i++) iResponse->addHeader(iHdrName[i], iHdrValue[i]);
+  iHdrCount = 0;
+}
+
+
+inline void EspBootstrapServerAsync::send(int aCode, const char* aType, const String& aContent) {
+  iStream = iRequest->beginResponseStream(aType);
+  iStream->setCode(aCode);
+  iStream->print(aContent);
+  start(iStream);
+}
+
+
+inline void EspBootstrapServerAsync::send_P(int aCode, const char* aType, PGM_P aData, size_t aLen) {
+  iStream = NULL;
+  start( iRequest->beginResponse_P(aCode, aType, (const uint8_t*) aData, aLen) );
+}
+
+#endif  // _BOOTSTRAP_ASYNC
+
+
+#endif // _ESPBOOTSTRAPSERVER_H_
@@ -0,0 +1,272 @@
+/*
+Copyright (c) 2015-2020, Anatoli Arkhipenko.
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its contributors
+   may be used to endorse or promote products derived from this software without
+   specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef _JSONCONFIG_H_
+#define _JSONCONFIG_H_
+
+
+#include <JsonConfigBase.h>
+#include <ParametersPool.h>
+
+
+//  Sinks: where parsed values are stored. A sink is constructed for every parse from
+//  the Target and the number of values given to parse(). Sinks with Counted set need
+//  that number, parse() without it does not compile for them. store() returns JSON_CHANGED for a new value, JSON_OK
+//  if the value was already there, or an error. Sinks with views() true also take a
+//  value as a view into the parsed buffer (not null-terminated). Staging tells whether
+//  values could be held back until the config is verified (JsonConfigHttpSource::verify()).
+
+struct JsonConfigStaged   { enum { Staged = true }; };
+struct JsonConfigUnstaged { enum { Staged = false }; };
+
+
+struct JsonConfigDictSink {
+    typedef ParametersDictionary& Target;
+    typedef JsonConfigStaged      Staging;
+    enum { Counted = false };
+
+    JsonConfigDictSink(ParametersDictionary& aDict, int aNum) : iDict(aDict), iStage(NULL) {};
+    inline bool   views() { return false; };
+    inline int8_t store(const char* aKey, const char* aValue) {
+      if ( iStage ) return iStage->insert(aKey, aValue) ? JSON_MEM : JSON_OK;  // reported when applied
+      if ( iDict[String(aKey)] == aValue ) return JSON_OK;  // unchanged
+      return iDict.insert(aKey, aValue) ? JSON_MEM : JSON_CHANGED;
+    };
+    inline int8_t store(const char* aKey, const char* aValue, size_t aLen) { return JSON_MEM; };
+
+    ParametersDictionary& iDict;
+    ParametersDictionary* iStage;
+};
+
+
+//  Values are stored in the map in order of appearance: aNum of parse() is the number of entries,
+//  values past it are not stored
+struct JsonConfigMapSink {
+    typedef char**                Target;
+    typedef JsonConfigUnstaged    Staging;
+    enum { Counted = true };
+
+    JsonConfigMapSink(char** aMap, int aNum) : iMap(aMap), iIndex(0), iNum(aNum > 0 ? aNum : 0) {};
+    inline bool   views() { return true; };
+    inline int8_t store(const char* aKey, const char* aValue) {
+      if ( iIndex >= iNum ) return JSON_MEM;
+      char* v = iMap[iIndex++];
+      if ( strcmp(v, aValue) == 0 ) return JSON_OK;
+      strcpy(v, aValue);
+      return JSON_CHANGED;
+    };
+    inline int8_t store(const char* aKey, const char* aValue, size_t aLen) {
+      if ( iIndex >= iNum ) return JSON_MEM;
+      char* v = iMap[iIndex++];
+      if ( strncmp(v, aValue, aLen) == 0 && v[aLen] == 0 ) return JSON_OK;
+      memcpy(v, aValue, aLen);
+      v[aLen] = 0;
+      return JSON_CHANGED;
+    };
+
+    char**          iMap;
+    size_t          iIndex;
+    size_t          iNum;
+};
+
+
+//  Every value is handed to a function (or a function object, which is inlined) returning 0 on success.
+//  The sink cannot tell old values from new ones, so each of them counts as changed.
+typedef int8_t (*JsonConfigStore)(const char* aKey, const char* aValue);
+
+template <class F = JsonConfigStore>
+struct JsonConfigCallbackSink {
+    typedef F                     Target;
+    typedef JsonConfigUnstaged    Staging;
+    enum { Counted = false };
+
+    JsonConfigCallbackSink(F aStore, int aNum) : iStore(aStore) {};
+    inline bool   views() { return false; };
+    inline int8_t store(const char* aKey, const char* aValue) { return iStore(aKey, aValue) ? JSON_MEM : JSON_CHANGED; };
+    inline int8_t store(const char* aKey, const char* aValue, size_t aLen) { return JSON_MEM; };
+
+    F               iStore;
+};
+
+
+//  Source of configs only parsed from memory: parse(aBuf, aLen, ...) and parse_P()
+struct JsonConfigBufferSource {};
+
+
+//  Config parser for a source policy (JsonConfigHttpSource, JsonConfigFileSource,
+//  JsonConfigBufferSource) and a sink policy. Sources open the config and hand the
+//  stream to a Run, which parses it straight into the sink: no virtual call per value.
+//  JsonConfigHttp, JsonConfigHttpMap, JsonConfigSPIFFS and JsonConfigSPIFFSMap are instances.
+template <class Source, class Sink>
+class JsonConfig : public JsonConfigBase, public Source {
+  public:
+    typedef typename Sink::Target Target;
+
+    JsonConfig();
+    virtual ~JsonConfig();
+    static JsonConfig& instance();
+
+    //  URL of an HTTP source, path of a file source
+    int8_t   parse(const String& aUrl, Target aTarget, int aNum);
+    int8_t   parse(const char* aUrl, Target aTarget, int aNum);
+    int8_t   parse(const String& aHost, uint16_t aPort, const String& aUrl, Target aTarget, int aNum);
+    //  Already open stream, e.g. a file or a client
+    int8_t   parse(Stream& aJson, Target aTarget, int aNum);
+
+    //  Config already in memory (RAM buffer or PROGMEM), e.g. compiled-in defaults or an MQTT payload
+    int8_t   parse(const char* aBuf, size_t aLen, Target aTarget, int aNum);
+    int8_t   parse_P(PGM_P aBuf, size_t aLen, Target aTarget, int aNum);
+
+    //  All values (aNum = 0): not for sinks which need the number of values, such as maps
+    template <class S = Sink> int8_t parse(const String& aUrl, Target aTarget) { return parse(aUrl, aTarget, _all<S>()); };
+    template <class S = Sink> int8_t parse(const char* aUrl, Target aTarget) { return parse(aUrl, aTarget, _all<S>()); };
+    template <class S = Sink> int8_t parse(const String& aHost, uint16_t aPort, const String& aUrl, Target aTarget) { return parse(aHost, aPort, aUrl, aTarget, _all<S>()); };
+    template <class S = Sink> int8_t parse(Stream& aJson, Target aTarget) { return parse(aJson, aTarget, _all<S>()); };
+    template <class S = Sink> int8_t parse(const char* aBuf, size_t aLen, Target aTarget) { return parse(aBuf, aLen, aTarget, _all<S>()); };
+    template <class S = Sink> int8_t parse_P(PGM_P aBuf, size_t aLen, Target aTarget) { return parse_P(aBuf, aLen, aTarget, _all<S>()); };
+
+    //  Signed configs of an HTTP source: only sinks which could hold the values back until
+    //  the signature is checked (Staging is JsonConfigStaged)
+    template <class S = Sink> void verify(const char* aKey) { _staged<S>(); Source::verify(aKey); };
+    template <class S = Sink> void verify(const char* aKey, const char* aHeader) { _staged<S>(); Source::verify(aKey, aHeader); };
+
+  private:
+    template <class S> static inline int _all() {
+      static_assert( !S::Counted, "this sink needs the number of values: parse(..., aTarget, aNum)" );
+      return 0;
+    };
+    template <class S> static inline void _staged() {
+      static_assert( S::Staging::Staged, "signed configs need a sink which stages values (a dictionary)" );
+    };
+
+    struct Run {
+      typedef typename Sink::Staging Staging;
+
+      Run(JsonConfig& aOwner, Target aTarget, int aNum) : iOwner(aOwner), iSink(aTarget, aNum), iNum(aNum) {};
+      int8_t  operator()(Stream& aJson);
+      int8_t  stage(Stream& aJson, ParametersDictionary& aStage);
+      int8_t  apply(ParametersDictionary& aStage);
+
+      JsonConfig&   iOwner;
+      Sink          iSink;
+      int           iNum;
+    };
+};
+
+
+template <class Source, class Sink>
+JsonConfig<Source, Sink>::JsonConfig() {}
+
+template <class Source, class Sink>
+JsonConfig<Source, Sink>::~JsonConfig() {}
+
+
+//  The shared instance: constructed on first use, one for all files of a sketch
+template <class Source, class Sink>
+JsonConfig<Source, Sink>& JsonConfig<Source, Sink>::instance() {
+  static JsonConfig shared;
+  return shared;
+}
+
+
+template <class Source, class Sink>
+int8_t JsonConfig<Source, Sink>::parse(const String& aUrl, Target aTarget, int aNum) {
+    Run run(*this, aTarget, aNum);
+    return Source::_fetch(aUrl, run);
+}
+
+
+template <class Source, class Sink>
+int8_t JsonConfig<Source, Sink>::parse(const char* aUrl, Target aTarget, int aNum) {
+    Run run(*this, aTarget, aNum);
+    return Source::_fetch(aUrl, run);
+}
+
+
+template <class Source, class Sink>
+int8_t JsonConfig<Source, Sink>::parse(const String& aHost, uint16_t aPort, const String& aUrl, Target aTarget, int aNum) {
+    Run run(*this, aTarget, aNum);
+    return Source::_fetch(aHost, aPort, aUrl, run);
+}
+
+
+template <class Source, class Sink>
+int8_t JsonConfig<Source, Sink>::parse(Stream& aJson, Target aTarget, int aNum) {
+    Run run(*this, aTarget, aNum);
+    return run(aJson);
+}
+
+
+template <class Source, class Sink>
+int8_t JsonConfig<Source, Sink>::parse(const char* aBuf, size_t aLen, Target aTarget, int aNum) {
+    JsonConfigBufferReader in(aBuf, aLen);
+    Sink sink(aTarget, aNum);
+    return _parse(in, sink, aNum);
+}
+
+
+template <class Source, class Sink>
+int8_t JsonConfig<Source, Sink>::parse_P(PGM_P aBuf, size_t aLen, Target aTarget, int aNum) {
+    JsonConfigProgmemReader in(aBuf, aLen);
+    Sink sink(aTarget, aNum);
+    return _parse(in, sink, aNum);
+}
+
+
+template <class Source, class Sink>
+int8_t JsonConfig<Source, Sink>::Run::operator()(Stream& aJson) {
+    JsonConfigStreamReader in(aJson);
+    return iOwner._parse(in, iSink, iNum);
+}
+
+
+template <class Source, class Sink>
+int8_t JsonConfig<Source, Sink>::Run::stage(Stream& aJson, ParametersDictionary& aStage) {
+    iSink.iStage = &aStage;
+    int8_t rc = (*this)(aJson);
+    iSink.iStage = NULL;
+    return rc;
+}
+
+
+template <class Source, class Sink>
+int8_t JsonConfig<Source, Sink>::Run::apply(ParametersDictionary& aStage) {
+    for (unsigned i = 0; i < aStage.count(); i++) {
+        String k = aStage(i);
+        String v = aStage[i];
+        int8_t rc = iSink.store(k.c_str(), v.c_str());
+        if ( rc < 0 ) return JSON_MEM;
+        if ( rc == JSON_CHANGED ) iOwner._keyChanged(k.c_str());
+    }
+    iOwner._notify();
+    return JSON_OK;
+}
+
+#endif // _JSONCONFIG_H_
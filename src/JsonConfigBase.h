@@ -35,6 +35,7 @@ POSSIBILITY OF SUCH DAMAGE.
 #include <Arduino.h>
 
 #define JSON_OK         0
+#define JSON_CHANGED    1   // sink: value stored and different from the previous one
 #define JSON_ERR      (-1)
 #define JSON_COMMA    (-20)
 #define JSON_COLON    (-21)
@@ -42,33 +43,469 @@ POSSIBILITY OF SUCH DAMAGE.
 #define JSON_BCKSL    (-23)
 #define JSON_MEM      (-24)
 #define JSON_FMT      (-25)
+#define JSON_DEPTH    (-27)
+#define JSON_PATH     (-28)
+#define JSON_KEYLEN   (-29)
+#define JSON_VALLEN   (-30)
+#define JSON_KEYCNT   (-31)
+#define JSON_SIZE     (-32)
+#define JSON_KEY      (-33)   // key is not one of the target's keys
 #define JSON_EOF      (-99)
 
+#ifndef JSON_MAX_CALLBACKS
+#define JSON_MAX_CALLBACKS  8
+#endif
+
+#ifndef JSON_MAX_DEPTH
+#define JSON_MAX_DEPTH      4   // nesting levels below the top level object
+#endif
+
+#ifndef JSON_MAX_PATH
+#define JSON_MAX_PATH       48  // length of the key prefix of nested values, e.g. "sensors.0."
+#endif
+
+#ifndef JSON_MAX_FILTERS
+#define JSON_MAX_FILTERS    8
+#endif
+
+//  Parse budget: a hostile or broken file cannot exhaust the heap. 0 = no limit.
+//  Off by default, so existing configurations keep parsing; _PARAMS_NOSTRING builds
+//  need the lengths to size the parser buffers.
+#if defined( _PARAMS_NOSTRING )
+
+#ifndef JSON_MAX_KEYLEN
+#define JSON_MAX_KEYLEN     64    // full (dotted) key length
+#endif
+
+#ifndef JSON_MAX_VALUELEN
+#define JSON_MAX_VALUELEN   2048  // value length, fits a PEM certificate
+#endif
+
+#ifndef JSON_MAX_KEYS
+#define JSON_MAX_KEYS       128   // number of stored values
+#endif
+
+#ifndef JSON_MAX_BYTES
+#define JSON_MAX_BYTES      8192  // total length of stored keys and values
+#endif
+
+#else
+
+#ifndef JSON_MAX_KEYLEN
+#define JSON_MAX_KEYLEN     0
+#endif
+
+#ifndef JSON_MAX_VALUELEN
+#define JSON_MAX_VALUELEN   0
+#endif
+
+#ifndef JSON_MAX_KEYS
+#define JSON_MAX_KEYS       0
+#endif
+
+#ifndef JSON_MAX_BYTES
+#define JSON_MAX_BYTES      0
+#endif
+
+#endif
+
+#if defined( _PARAMS_NOSTRING ) && ( JSON_MAX_KEYLEN == 0 || JSON_MAX_VALUELEN == 0 )
+#error "_PARAMS_NOSTRING: JSON_MAX_KEYLEN and JSON_MAX_VALUELEN size the parser buffers and cannot be 0"
+#endif
+
+#define JSON_KEEP       1   // filter: value of this key is wanted
+#define JSON_DESCEND    2   // filter: a wanted key could be nested below this key
+
+typedef void (*JsonConfigCallback)(const char* aKey);
+
+
+//  Fixed capacity text over a caller's buffer, used by the parser instead of String
+//  in _PARAMS_NOSTRING builds. Text beyond the capacity is dropped, but length() keeps
+//  counting, so the parser limit checks report the overflow.
+class JsonConfigText {
+  public:
+    JsonConfigText(char* aBuf, size_t aSize) { iBuf = aBuf; iSize = aSize; iLen = 0; iBuf[0] = 0; };
+
+    inline size_t       length() const { return iLen; };
+    inline const char*  c_str() const { return iBuf; };
+
+    bool concat(const char* aStr, size_t aLen) {
+      size_t n = ( iLen < iSize - 1 ) ? iSize - 1 - iLen : 0;
+      if ( n > aLen ) n = aLen;
+      memcpy(iBuf + iLen, aStr, n);
+      if ( n ) iBuf[iLen + n] = 0;
+      iLen += aLen;
+      return ( iLen < iSize );
+    };
+    inline bool concat(char aChar) { return concat(&aChar, 1); };
+    bool concat(unsigned aNum) {
+      char b[12];
+      return concat(b, snprintf(b, sizeof(b), "%u", aNum));
+    };
+    void remove(size_t aPos) {
+      if ( aPos >= iLen ) return;
+      iLen = aPos;
+      if ( aPos < iSize ) iBuf[aPos] = 0;
+    };
+    JsonConfigText& operator=(const JsonConfigText& aText) { remove(0); return (*this += aText); };
+    JsonConfigText& operator+=(const JsonConfigText& aText) {
+      size_t n = ( aText.iLen < aText.iSize ) ? aText.iLen : aText.iSize - 1;
+      concat(aText.iBuf, n);
+      iLen += aText.iLen - n;   // overflow of the source carries over
+      return *this;
+    };
+    JsonConfigText& operator+=(char aChar) { concat(aChar); return *this; };
+
+  private:
+    char*           iBuf;
+    size_t          iSize;
+    size_t          iLen;
+};
+
+
+//  Length of the run before the next '"', '\\' or newline - the only special characters
+//  inside a quoted string. Scanned a machine word (4 or 8 bytes) at a time: a byte of the
+//  word equals b if (w ^ b*ONES) has a zero byte, found with (x - ONES) & ~x & HIGHS.
+static inline size_t __jsonconfig_plain(const char* aPos, const char* aEnd) {
+    const size_t ones = ((size_t) -1) / 0xFF;
+    const size_t highs = ones * 0x80;
+    const char* p = aPos;
+
+    //  byte by byte up to a word boundary: aligned loads only (required on Xtensa)
+    while ( p < aEnd && ((uintptr_t) p & (sizeof(size_t) - 1)) ) {
+        if ( *p == '\"' || *p == '\\' || *p == '\n' ) return p - aPos;
+        p++;
+    }
+    while ( p + sizeof(size_t) <= aEnd ) {
+        size_t w;
+        memcpy(&w, p, sizeof(w));   // no aliasing of the char buffer, still a single aligned load
+        size_t q = w ^ (ones * '\"');
+        size_t b = w ^ (ones * '\\');
+        size_t n = w ^ (ones * '\n');
+        if ( ( ((q - ones) & ~q) | ((b - ones) & ~b) | ((n - ones) & ~n) ) & highs ) break;
+        p += sizeof(size_t);
+    }
+    while ( p < aEnd && *p != '\"' && *p != '\\' && *p != '\n' ) p++;
+    return p - aPos;
+}
+
+
+//  Input readers of the parser core. last() points to the character just read
+//  when the input is a memory buffer, so values could be passed on without a copy,
+//  and plain() reports how many of the following characters could be taken in bulk.
+struct JsonConfigStreamReader {
+    JsonConfigStreamReader(Stream& aStream) : iStream(aStream) {};
+    inline int          peek() { return iStream.peek(); };
+    inline int          read() { return iStream.read(); };
+    inline const char*  last() { return NULL; };
+    inline const char*  pos() { return NULL; };
+    inline size_t       plain() { return 0; };
+    inline void         skip(size_t aLen) {};
+
+    Stream&             iStream;
+};
+
+struct JsonConfigBufferReader {
+    JsonConfigBufferReader(const char* aBuf, size_t aLen) { iPos = aBuf; iEnd = aBuf + aLen; };
+    inline int          peek() { return ( iPos < iEnd ) ? (uint8_t) *iPos : -1; };
+    inline int          read() { return ( iPos < iEnd ) ? (uint8_t) *iPos++ : -1; };
+    inline const char*  last() { return iPos - 1; };
+    inline const char*  pos() { return iPos; };
+    inline size_t       plain() { return __jsonconfig_plain(iPos, iEnd); };
+    inline void         skip(size_t aLen) { iPos += aLen; };
+
+    const char*         iPos;
+    const char*         iEnd;
+};
+
+struct JsonConfigProgmemReader {
+    JsonConfigProgmemReader(PGM_P aBuf, size_t aLen) { iPos = aBuf; iEnd = aBuf + aLen; };
+    inline int          peek() { return ( iPos < iEnd ) ? pgm_read_byte(iPos) : -1; };
+    inline int          read() { return ( iPos < iEnd ) ? pgm_read_byte(iPos++) : -1; };
+    inline const char*  last() { return NULL; };
+    inline const char*  pos() { return NULL; };
+    inline size_t       plain() { return 0; };
+    inline void         skip(size_t aLen) {};
+
+    PGM_P               iPos;
+    PGM_P               iEnd;
+};
+
+
 class JsonConfigBase {
   public:
     JsonConfigBase();
     virtual ~JsonConfigBase();
+
+    //  Callbacks are invoked after a successful parse if matching values actually changed.
+    //  aKey string should stay valid (e.g., a literal). Prefix callbacks are invoked once with the prefix.
+    int8_t          onChange(const char* aKey, JsonConfigCallback aCallback, bool aPrefix = false);
+    inline uint16_t changed() { return iChanged; };
+
+    //  Only matching keys (full dotted keys of nested values) are stored, other values
+    //  and subtrees are skipped without buffering. No filters - everything is stored.
+    int8_t          filter(const char* aKey, bool aPrefix = false);
+    inline void     clearFilters() { iNumFilters = 0; };
+
+    void            limits(uint16_t aKeyLen, uint16_t aValueLen, uint16_t aKeys, uint32_t aBytes);
     
   protected:
-    virtual int8_t  _doParse(Stream& aJson, uint16_t aNum);
+    int8_t          _doParse(Stream& aJson, uint16_t aNum);
+    int8_t          _doParse(const char* aBuf, size_t aLen, uint16_t aNum);
+    int8_t          _doParse_P(PGM_P aBuf, size_t aLen, uint16_t aNum);
+    template <class R, class S>
+    int8_t          _parse(R& aIn, S& aSink, uint16_t aNum);
+
     virtual int8_t  _storeKeyValue(const char* aKey, const char* aValue) { return JSON_MEM; };
+    //  Value given as a view into the parsed buffer (not null-terminated).
+    //  Sinks able to take it as is should override this, by default it is copied.
+    virtual int8_t  _storeKeyValue(const char* aKey, const char* aValue, size_t aLen);
+    void            _keyChanged(const char* aKey);
+    void            _notify();
+    uint8_t         _match(const char* aKey, size_t aLen);
+
+    //  Sink of the classes overriding _storeKeyValue(): the parser reaches them through the vtable.
+    //  These report changed keys themselves, so the sink never returns JSON_CHANGED.
+    //  Dictionary errors are reported as JSON_MEM, an unknown key as JSON_KEY.
+    struct VirtualSink {
+      VirtualSink(JsonConfigBase& aOwner) : iOwner(aOwner) {};
+      inline bool   views() { return true; };
+      inline int8_t store(const char* aKey, const char* aValue) { return result( iOwner._storeKeyValue(aKey, aValue) ); };
+      inline int8_t store(const char* aKey, const char* aValue, size_t aLen) { return result( iOwner._storeKeyValue(aKey, aValue, aLen) ); };
+      static inline int8_t result(int8_t aRc) { return aRc == JSON_KEY ? JSON_KEY : ( aRc ? JSON_MEM : JSON_OK ); };
+
+      JsonConfigBase& iOwner;
+    };
+
+  private:
+
+    struct {
+      const char*         key;
+      JsonConfigCallback  callback;
+      bool                prefix;
+      bool                fired;
+    }               iCallbacks[JSON_MAX_CALLBACKS];
+    uint8_t         iNumCallbacks;
+
+    struct {
+      const char*         key;
+      bool                prefix;
+    }               iFilters[JSON_MAX_FILTERS];
+    uint8_t         iNumFilters;
+
+    uint16_t        iMaxKeyLen;
+    uint16_t        iMaxValueLen;
+    uint16_t        iMaxKeys;
+    uint32_t        iMaxBytes;
+    uint16_t        iChanged;
+
+#if defined( _PARAMS_NOSTRING )
+    char            iKeyBuf[JSON_MAX_KEYLEN + 1];
+    char            iCurrentKeyBuf[JSON_MAX_KEYLEN + 1];
+    char            iPathBuf[JSON_MAX_PATH + 1];
+    char            iValueBuf[JSON_MAX_VALUELEN + 1];
+#endif
 };
 
-JsonConfigBase::JsonConfigBase() {}
-JsonConfigBase::~JsonConfigBase() {}
+#ifndef JSON_TEE_BUF
+#define JSON_TEE_BUF    64        // bytes collected before a write to the sink
+#endif
+
+
+//  Stream passing every byte read from the source on to a sink as well
+class JsonConfigTee : public Stream {
+  public:
+    JsonConfigTee(Stream& aSrc, Print& aSink) : iSrc(aSrc), iSink(aSink) { iLen = 0; iTotal = 0; iFailed = false; };
+    virtual ~JsonConfigTee() { flush(); };
+
+    virtual int     available() { return iSrc.available(); };
+    virtual int     peek() { return iSrc.peek(); };
+    virtual int     read() {
+      int c = iSrc.read();
+      if ( c >= 0 ) {
+        iBuf[iLen++] = (uint8_t) c;
+        iTotal++;
+        if ( iLen == JSON_TEE_BUF ) flush();
+      }
+      return c;
+    };
+    virtual void    flush() {
+      if ( iLen && iSink.write(iBuf, iLen) != iLen ) iFailed = true;
+      iLen = 0;
+    };
+    virtual size_t  write(uint8_t) { return 0; };
+
+    inline size_t   length() { return iTotal; };    // bytes read through the tee
+    inline bool     failed() { return iFailed; };   // the sink did not take all of them
+
+  private:
+    Stream&         iSrc;
+    Print&          iSink;
+    uint8_t         iBuf[JSON_TEE_BUF];
+    size_t          iLen;
+    size_t          iTotal;
+    bool            iFailed;
+};
 
-int8_t JsonConfigBase::_doParse(Stream& aJson, uint16_t aNum) {
+
+inline JsonConfigBase::JsonConfigBase() {
+  iNumCallbacks = 0;
+  iNumFilters = 0;
+  limits(JSON_MAX_KEYLEN, JSON_MAX_VALUELEN, JSON_MAX_KEYS, JSON_MAX_BYTES);
+  iChanged = 0;
+}
+
+inline JsonConfigBase::~JsonConfigBase() {}
+
+
+inline int8_t JsonConfigBase::onChange(const char* aKey, JsonConfigCallback aCallback, bool aPrefix) {
+  if ( iNumCallbacks >= JSON_MAX_CALLBACKS ) return JSON_MEM;
+
+  iCallbacks[iNumCallbacks].key = aKey;
+  iCallbacks[iNumCallbacks].callback = aCallback;
+  iCallbacks[iNumCallbacks].prefix = aPrefix;
+  iCallbacks[iNumCallbacks].fired = false;
+  iNumCallbacks++;
+  return JSON_OK;
+}
+
+
+inline void JsonConfigBase::limits(uint16_t aKeyLen, uint16_t aValueLen, uint16_t aKeys, uint32_t aBytes) {
+#if defined( _PARAMS_NOSTRING )
+  //  parser buffers are fixed: lengths could only be lowered
+  if ( aKeyLen == 0 || aKeyLen > JSON_MAX_KEYLEN ) aKeyLen = JSON_MAX_KEYLEN;
+  if ( aValueLen == 0 || aValueLen > JSON_MAX_VALUELEN ) aValueLen = JSON_MAX_VALUELEN;
+#endif
+  iMaxKeyLen = aKeyLen;
+  iMaxValueLen = aValueLen;
+  iMaxKeys = aKeys;
+  iMaxBytes = aBytes;
+}
+
+
+inline int8_t JsonConfigBase::filter(const char* aKey, bool aPrefix) {
+  if ( iNumFilters >= JSON_MAX_FILTERS ) return JSON_MEM;
+
+  iFilters[iNumFilters].key = aKey;
+  iFilters[iNumFilters].prefix = aPrefix;
+  iNumFilters++;
+  return JSON_OK;
+}
+
+
+//  JSON_KEEP if the key passes the filters, JSON_DESCEND if it could be a parent of a key that does
+inline uint8_t JsonConfigBase::_match(const char* aKey, size_t aLen) {
+  uint8_t rc = 0;
+
+  if ( iNumFilters == 0 ) return JSON_KEEP | JSON_DESCEND;
+  for (uint8_t i = 0; i < iNumFilters; i++) {
+    const char* f = iFilters[i].key;
+    if ( iFilters[i].prefix && strncmp(aKey, f, strlen(f)) == 0 ) return JSON_KEEP | JSON_DESCEND;
+    if ( !iFilters[i].prefix && strcmp(aKey, f) == 0 ) rc |= JSON_KEEP;
+    if ( strncmp(f, aKey, aLen) == 0 && f[aLen] == '.' ) rc |= JSON_DESCEND;
+  }
+  return rc;
+}
+
+
+//  Sinks report keys with new values here
+inline void JsonConfigBase::_keyChanged(const char* aKey) {
+  iChanged++;
+  for (uint8_t i = 0; i < iNumCallbacks; i++) {
+    if ( iCallbacks[i].prefix ) {
+      if ( strncmp(aKey, iCallbacks[i].key, strlen(iCallbacks[i].key)) == 0 ) iCallbacks[i].fired = true;
+    }
+    else {
+      if ( strcmp(aKey, iCallbacks[i].key) == 0 ) iCallbacks[i].fired = true;
+    }
+  }
+}
+
+
+inline void JsonConfigBase::_notify() {
+  for (uint8_t i = 0; i < iNumCallbacks; i++) {
+    if ( iCallbacks[i].fired ) {
+      iCallbacks[i].fired = false;
+      iCallbacks[i].callback(iCallbacks[i].key);
+    }
+  }
+}
+
+//  Nested objects and arrays are flattened into dotted keys: {"mqtt":{"host":"h"},"pins":[1,2]}
+//  is stored as "mqtt.host", "pins.0" and "pins.1". Only the key path of the enclosing
+//  containers is kept (up to JSON_MAX_DEPTH levels and JSON_MAX_PATH characters).
+inline int8_t JsonConfigBase::_storeKeyValue(const char* aKey, const char* aValue, size_t aLen) {
+#if defined( _PARAMS_NOSTRING )
+    JsonConfigText v(iValueBuf, sizeof(iValueBuf));
+#else
+    String v;
+#endif
+    if ( !v.concat(aValue, aLen) ) return JSON_MEM;
+    return _storeKeyValue(aKey, v.c_str());
+}
+
+
+inline int8_t JsonConfigBase::_doParse(Stream& aJson, uint16_t aNum) {
+    JsonConfigStreamReader in(aJson);
+    VirtualSink sink(*this);
+    return _parse(in, sink, aNum);
+}
+
+
+//  Configs already in memory: no Stream wrapper, unescaped values are not copied while parsing
+inline int8_t JsonConfigBase::_doParse(const char* aBuf, size_t aLen, uint16_t aNum) {
+    JsonConfigBufferReader in(aBuf, aLen);
+    VirtualSink sink(*this);
+    return _parse(in, sink, aNum);
+}
+
+
+inline int8_t JsonConfigBase::_doParse_P(PGM_P aBuf, size_t aLen, uint16_t aNum) {
+    JsonConfigProgmemReader in(aBuf, aLen);
+    VirtualSink sink(*this);
+    return _parse(in, sink, aNum);
+}
+
+
+//  The sink is a template argument, so its store() is inlined into the loop (sinks: JsonConfig.h)
+template <class R, class S>
+int8_t JsonConfigBase::_parse(R& aIn, S& aSink, uint16_t aNum) {
     bool insideQoute = false;
     bool nextVerbatim = false;
     bool isValue = false;
     bool isComment = false;
+    bool isClosed = false;      // nested container just ended, a separator may follow
+    bool hasValue = false;      // value started, its key is known and checked against the filters
+    uint8_t match = 0;          // filter result for the current key
+    uint8_t skip = 0;           // nesting level of a subtree being skipped
     int p = 0;
+    uint32_t total = 0;         // stored bytes, checked against the budget
     int8_t rc;
+#if defined( _PARAMS_NOSTRING )
+    JsonConfigText key(iKeyBuf, sizeof(iKeyBuf));
+    JsonConfigText currentKey(iCurrentKeyBuf, sizeof(iCurrentKeyBuf));
+    JsonConfigText currentValue(iValueBuf, sizeof(iValueBuf));
+    JsonConfigText path(iPathBuf, sizeof(iPathBuf));
+#else
+    String key;                 // full key of the current value
     String currentKey;
     String currentValue;
+    String path;                // key prefix of the current container, e.g. "mqtt."
+#endif
+    const char* view = NULL;    // value still in the input buffer: view[0..viewLen)
+    size_t viewLen = 0;
+    uint8_t depth = 0;          // 0 = top level object
+    uint16_t pathLen[JSON_MAX_DEPTH];
+    bool    isArray[JSON_MAX_DEPTH];
+    uint16_t index[JSON_MAX_DEPTH];
+
+    iChanged = 0;
+    for (uint8_t i = 0; i < iNumCallbacks; i++) iCallbacks[i].fired = false;
 
-    while ( aJson.peek() >= 0 ) {
-        char c = aJson.read();
+    while ( aIn.peek() >= 0 ) {
+        char c = aIn.read();
+        bool inArray = ( depth > 0 && isArray[depth - 1] );
+        bool quoteOpen = false;
         
 //#ifdef _LIBDEBUG_
 //Serial.print((uint8_t)c);
@@ -80,14 +517,32 @@ int8_t JsonConfigBase::_doParse(Stream& aJson, uint16_t aNum) {
         if ( isComment ) {
           if ( c == '\n' ) {
             isComment = false;
-            isValue = false;
+            if ( !skip ) isValue = inArray;
           }
           continue;
         }
         if (nextVerbatim) {
           nextVerbatim = false;
+          if ( skip ) continue;
         }
         
+        //  skip-scan of a subtree nobody asked for: only quotes, comments and brackets matter
+        else if ( skip ) {
+          if ( c == '\\' ) nextVerbatim = true;
+          else if ( c == '\"' ) insideQoute = !insideQoute;
+          else if ( insideQoute ) aIn.skip(aIn.plain());
+          else if ( c == '#' ) isComment = true;
+          else if ( c == '{' || c == '[' ) skip++;
+          else if ( c == '}' || c == ']' ) {
+            if ( --skip == 0 ) {
+              isClosed = true;
+              isValue = inArray;
+              currentKey.remove(0);
+            }
+          }
+          continue;
+        }
+
         //  not a comment and not a verbatim char
         else {
           // process all special cases: '\', '"', ':', and ','
@@ -99,13 +554,14 @@ int8_t JsonConfigBase::_doParse(Stream& aJson, uint16_t aNum) {
           if ( c == '\"' ) {
             if (!insideQoute) {
               if ( isValue ) {
-                if ( currentValue.length() > 0 ) return JSON_FMT;
+                if ( hasValue ) return JSON_FMT;
               }
               else {
                 if ( currentKey.length() > 0 ) return JSON_FMT;
               }
               insideQoute = true;
-              continue;
+              if ( !isValue ) continue;
+              quoteOpen = true;     // value starts with the quote
             }
             else {
               insideQoute = false;
@@ -140,33 +596,134 @@ int8_t JsonConfigBase::_doParse(Stream& aJson, uint16_t aNum) {
               continue;
             }
 
-            if ( c == '{' || c == ' ' || c == '\t'  || c == '\r' ) continue;
+            if ( c == '{' || c == '[' ) {
+              if ( isValue && !hasValue && !isClosed ) {
+                //  nested container: its key (or array index) becomes part of the path
+                key = path;
+                if ( inArray ) key.concat((unsigned) index[depth - 1]);
+                else key += currentKey;
+                if ( !(_match(key.c_str(), key.length()) & JSON_DESCEND) ) {
+                  skip = 1;
+                  continue;
+                }
+                if ( depth >= JSON_MAX_DEPTH ) return JSON_DEPTH;
+                pathLen[depth] = path.length();
+                path = key;
+                path += '.';
+                if ( path.length() > JSON_MAX_PATH ) return JSON_PATH;
+                isArray[depth] = ( c == '[' );
+                index[depth] = 0;
+                depth++;
+                currentKey.remove(0);
+                isValue = ( c == '[' );
+                continue;
+              }
+              if ( c == '{' && depth == 0 && !isValue && currentKey.length() == 0 ) continue;  // top level braces
+              return JSON_FMT;
+            }
+
+            if ( c == ' ' || c == '\t'  || c == '\r' ) continue;
+            if ( c == '\n' && inArray ) continue;  // arrays could span several lines
             
-            if ( c == ',' || c == '\n' || c == '}') {
-              if ( isValue ) {
-                if ( currentValue.length() == 0 ) return JSON_FMT;
-                isValue = false;
-                rc = _storeKeyValue( currentKey.c_str(), currentValue.c_str() );
-                if (rc) return JSON_MEM;  // if error - exit with an error code
-                currentValue = String();
-                currentKey = String();
-                p++;
+            if ( c == ',' || c == '\n' || c == '}' || c == ']' ) {
+              if ( (c == ']') != inArray && (c == '}' || c == ']') && depth > 0 ) return JSON_FMT;
+              if ( c == ']' && depth == 0 ) return JSON_FMT;
+              if ( isValue && hasValue ) {
+                if ( match & JSON_KEEP ) {
+                  if ( currentValue.length() + viewLen == 0 ) return JSON_FMT;
+                  if ( iMaxKeys && p >= iMaxKeys ) return JSON_KEYCNT;
+                  total += key.length() + currentValue.length() + viewLen;
+                  if ( iMaxBytes && total > iMaxBytes ) return JSON_SIZE;
+                  if ( viewLen && aSink.views() ) rc = aSink.store( key.c_str(), view, viewLen );
+                  else {
+                    if ( viewLen ) currentValue.concat(view, viewLen);
+                    rc = aSink.store( key.c_str(), currentValue.c_str() );
+                  }
+                  if ( rc < 0 ) return JSON_MEM;  // if error - exit with an error code
+                  if ( rc == JSON_CHANGED ) _keyChanged( key.c_str() );
+                  p++;
+                }
+                if ( inArray ) index[depth - 1]++;
+                isValue = inArray;
+                hasValue = false;
+                currentValue.remove(0);
+                viewLen = 0;
+                currentKey.remove(0);
                 if (aNum > 0 && p >= aNum) break;
               }
+              else if ( isClosed ) {
+                if ( inArray && c == ',' ) index[depth - 1]++;
+              }
+              else if ( isValue && !inArray ) {
+                return JSON_FMT;
+              }
               else {
                 if ( c == ',' ) return JSON_FMT;
               }
+              isClosed = false;
+              if ( (c == '}' || c == ']') && depth > 0 ) {
+                depth--;
+                path.remove(pathLen[depth]);
+                isClosed = true;
+                isValue = ( depth > 0 && isArray[depth - 1] );
+              }
               continue;
             }
           }
         }
-        if (isValue) currentValue.concat(c);
-        else currentKey.concat(c);
+        if (isValue) {
+          if ( !hasValue ) {
+            //  the key is complete: rejected values are scanned but never buffered
+            key = path;
+            if ( inArray ) key.concat((unsigned) index[depth - 1]);
+            else key += currentKey;
+            if ( iMaxKeyLen && key.length() > iMaxKeyLen ) return JSON_KEYLEN;
+            match = _match(key.c_str(), key.length());
+            hasValue = true;
+          }
+          if ( !quoteOpen && (match & JSON_KEEP) ) {
+            if ( iMaxValueLen && currentValue.length() + viewLen >= iMaxValueLen ) return JSON_VALLEN;
+            const char* at = aIn.last();
+            if ( at && currentValue.length() == 0 && ( viewLen == 0 || at == view + viewLen ) ) {
+              if ( viewLen == 0 ) view = at;
+              viewLen++;
+            }
+            else {
+              //  not contiguous (escaped characters): materialized from here on
+              if ( viewLen ) currentValue.concat(view, viewLen);
+              viewLen = 0;
+              currentValue.concat(c);
+            }
+          }
+          //  plain run of a quoted value (buffered input only) is taken in one go
+          size_t n = ( insideQoute ? aIn.plain() : 0 );
+          if ( n ) {
+            if ( match & JSON_KEEP ) {
+              if ( iMaxValueLen && currentValue.length() + viewLen + n > iMaxValueLen ) return JSON_VALLEN;
+              const char* at = aIn.pos();
+              if ( currentValue.length() == 0 && ( viewLen == 0 || at == view + viewLen ) ) {
+                if ( viewLen == 0 ) view = at;
+                viewLen += n;
+              }
+              else {
+                if ( viewLen ) currentValue.concat(view, viewLen);
+                viewLen = 0;
+                currentValue.concat(at, n);
+              }
+            }
+            aIn.skip(n);
+          }
+        }
+        else {
+          if ( iMaxKeyLen && currentKey.length() >= iMaxKeyLen ) return JSON_KEYLEN;
+          currentKey.concat(c);
+        }
       }
-      if (insideQoute || nextVerbatim || (aNum > 0 && p < aNum )) return JSON_EOF;
+      if (insideQoute || nextVerbatim || skip || depth > 0 || (aNum > 0 && p < aNum )) return JSON_EOF;
     #ifdef _LIBDEBUG_
         Serial.printf("Dictionary::jload: DICTIONARY_OK\n");
     #endif
+      _notify();
       return JSON_OK;
 }
 
@@ -0,0 +1,114 @@
+#ifndef _JSONCONFIGCACHE_H_
+#define _JSONCONFIGCACHE_H_
+
+/*
+  Copyright (c) 2015-2020, Anatoli Arkhipenko.
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without modification,
+  are permitted provided that the following conditions are met:
+
+  1. Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+
+  2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+  3. Neither the name of the copyright holder nor the names of its contributors
+   may be used to endorse or promote products derived from this software without
+   specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+  OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <Arduino.h>
+#include <JsonConfigBase.h>
+
+#if defined( ARDUINO_ARCH_ESP8266 ) || defined( ARDUINO_ARCH_ESP32 )
+#include <FS.h>
+#endif
+
+#ifndef JSON_CACHE_TMP
+#define JSON_CACHE_TMP  ".tmp"    // suffix of the file being written during the download
+#endif
+
+
+//  Local copy of a downloaded config: the body is written to a temp file while being parsed,
+//  and replaces the cached file only if the parse succeeded, so the cache always holds the last good config.
+//  Nothing is written without a path and a filesystem.
+class JsonConfigCache {
+  public:
+    JsonConfigCache(const String& aPath, Stream& aSrc, fs::FS* aFS);
+    ~JsonConfigCache();
+
+    inline Stream&  stream() { return iTee ? *iTee : iSrc; };
+    inline bool     active() { return iTee != NULL; };
+    inline size_t   length() { return iTee ? iTee->length() : 0; };
+    bool            commit(bool aOk);
+
+  private:
+    String          iPath;
+    String          iTmp;
+    Stream&         iSrc;
+    fs::FS*         iFS;
+    File            iFile;
+    JsonConfigTee*  iTee;
+};
+
+
+inline JsonConfigCache::JsonConfigCache(const String& aPath, Stream& aSrc, fs::FS* aFS) : iSrc(aSrc), iFS(aFS) {
+  iTee = NULL;
+  if ( aPath.length() == 0 || iFS == NULL ) return;
+
+  iPath = aPath;
+  iTmp = aPath + JSON_CACHE_TMP;
+  iFile = iFS->open(iTmp, "w");
+  if ( iFile ) iTee = new JsonConfigTee(aSrc, iFile);
+#ifdef _LIBDEBUG_
+  if ( !iTee ) Serial.printf("JsonConfigCache: cannot write %s\n", iTmp.c_str());
+#endif
+}
+
+
+inline JsonConfigCache::~JsonConfigCache() {
+  if ( iTee ) commit(false);
+}
+
+
+//  Rename is atomic where the filesystem allows replacing the target (LittleFS),
+//  SPIFFS needs the old file removed first. A temp file that could not be written completely is discarded
+inline bool JsonConfigCache::commit(bool aOk) {
+  if ( !iTee ) return false;
+
+  iTee->flush();
+  aOk = aOk && !iTee->failed();
+  delete iTee;
+  iTee = NULL;
+  iFile.close();
+
+  if ( !aOk ) {
+    iFS->remove(iTmp);
+    return false;
+  }
+  if ( iFS->rename(iTmp, iPath) ) return true;
+  iFS->remove(iPath);
+  if ( iFS->rename(iTmp, iPath) ) return true;
+#ifdef _LIBDEBUG_
+  Serial.printf("JsonConfigCache: cannot replace %s\n", iPath.c_str());
+#endif
+  iFS->remove(iTmp);
+  return false;
+}
+
+
+#endif // _JSONCONFIGCACHE_H_
@@ -0,0 +1,82 @@
+/*
+Copyright (c) 2015-2020, Anatoli Arkhipenko.
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its contributors
+   may be used to endorse or promote products derived from this software without
+   specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef _JSONCONFIGFILESOURCE_H_
+#define _JSONCONFIGFILESOURCE_H_
+
+
+#include <JsonConfigBase.h>
+
+#if defined( ARDUINO_ARCH_ESP8266 )
+#include <FS.h>
+#endif
+
+#if defined( ARDUINO_ARCH_ESP32 )
+#include <FS.h>
+#include <SPIFFS.h>
+#endif
+
+#define JSON_FILERR  (-95)
+#define JSON_FILENE  (-96)
+
+
+//  Source policy of JsonConfig: config file on SPIFFS, or on another filesystem (e.g., LittleFS)
+class JsonConfigFileSource {
+  public:
+    JsonConfigFileSource() { iFS = &SPIFFS; };
+    inline void filesystem(fs::FS& aFS) { iFS = &aFS; };
+
+  protected:
+    template <class P>
+    int8_t          _fetch(const char* aPath, P& aRun);
+    template <class P>
+    inline int8_t   _fetch(const String& aPath, P& aRun) { return _fetch(aPath.c_str(), aRun); };
+
+  private:
+    fs::FS*         iFS;
+};
+
+
+template <class P>
+int8_t JsonConfigFileSource::_fetch(const char* aPath, P& aRun) {
+    int8_t rc;
+
+    //  open() alone tells a missing file: an exists() first would look the name up twice
+    File f = iFS->open(aPath, "r");
+    if ( !f ) {
+      return JSON_FILENE;
+    }
+
+    rc = aRun(f);
+    f.close();
+    return rc;
+}
+
+#endif // _JSONCONFIGFILESOURCE_H_
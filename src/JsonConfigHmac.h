@@ -0,0 +1,272 @@
+#ifndef _JSONCONFIGHMAC_H_
+#define _JSONCONFIGHMAC_H_
+
+/*
+  Copyright (c) 2015-2020, Anatoli Arkhipenko.
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without modification,
+  are permitted provided that the following conditions are met:
+
+  1. Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+
+  2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+  3. Neither the name of the copyright holder nor the names of its contributors
+   may be used to endorse or promote products derived from this software without
+   specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+  OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <Arduino.h>
+
+//  HMAC-SHA256 backend: mbedTLS on ESP32 (SHA accelerator), BearSSL on ESP8266,
+//  portable implementation elsewhere or with _JSON_HMAC_SOFT defined
+#if !defined( _JSON_HMAC_SOFT )
+#if defined( ARDUINO_ARCH_ESP32 )
+#define _JSON_HMAC_MBEDTLS
+#include <mbedtls/md.h>
+#elif defined( ARDUINO_ARCH_ESP8266 )
+#define _JSON_HMAC_BEARSSL
+#include <bearssl/bearssl_hmac.h>
+#else
+#define _JSON_HMAC_SOFT
+#endif
+#endif
+
+#define JSON_HMAC_LEN   32        // SHA-256 output, bytes
+
+
+//  Incremental HMAC-SHA256: bytes written to this Print are authenticated,
+//  so it could be the sink of a JsonConfigTee while the config is being parsed
+class JsonConfigHmac : public Print {
+  public:
+    JsonConfigHmac(const uint8_t* aKey, size_t aKeyLen);
+    virtual ~JsonConfigHmac();
+
+    virtual size_t  write(uint8_t aByte) { return write(&aByte, 1); };
+    virtual size_t  write(const uint8_t* aData, size_t aLen);
+
+    void            finish(uint8_t* aMac);
+    bool            matches(const char* aHex);
+
+  private:
+#if defined( _JSON_HMAC_MBEDTLS )
+    mbedtls_md_context_t  iCtx;
+#elif defined( _JSON_HMAC_BEARSSL )
+    br_hmac_key_context   iKey;
+    br_hmac_context       iCtx;
+#else
+    void            begin();
+    void            update(const uint8_t* aData, size_t aLen);
+    void            end(uint8_t* aHash);
+    void            block(const uint8_t* aBlock);
+
+    uint32_t        iState[8];
+    uint8_t         iBlock[64];
+    uint8_t         iFill;
+    uint64_t        iTotal;
+    uint8_t         iPad[64];    // key xor opad, for the outer hash
+#endif
+};
+
+
+#if defined( _JSON_HMAC_MBEDTLS )
+
+inline JsonConfigHmac::JsonConfigHmac(const uint8_t* aKey, size_t aKeyLen) {
+  mbedtls_md_init(&iCtx);
+  mbedtls_md_setup(&iCtx, mbedtls_md_info_from_type(MBEDTLS_MD_SHA256), 1);
+  mbedtls_md_hmac_starts(&iCtx, aKey, aKeyLen);
+}
+
+inline JsonConfigHmac::~JsonConfigHmac() {
+  mbedtls_md_free(&iCtx);
+}
+
+inline size_t JsonConfigHmac::write(const uint8_t* aData, size_t aLen) {
+  mbedtls_md_hmac_update(&iCtx, aData, aLen);
+  return aLen;
+}
+
+inline void JsonConfigHmac::finish(uint8_t* aMac) {
+  mbedtls_md_hmac_finish(&iCtx, aMac);
+}
+
+#elif defined( _JSON_HMAC_BEARSSL )
+
+inline JsonConfigHmac::JsonConfigHmac(const uint8_t* aKey, size_t aKeyLen) {
+  br_hmac_key_init(&iKey, &br_sha256_vtable, aKey, aKeyLen);
+  br_hmac_init(&iCtx, &iKey, 0);
+}
+
+inline JsonConfigHmac::~JsonConfigHmac() {}
+
+inline size_t JsonConfigHmac::write(const uint8_t* aData, size_t aLen) {
+  br_hmac_update(&iCtx, aData, aLen);
+  return aLen;
+}
+
+inline void JsonConfigHmac::finish(uint8_t* aMac) {
+  br_hmac_out(&iCtx, aMac);
+}
+
+#else
+
+static const uint32_t __jsonconfig_sha256_k[64] = {
+  0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+  0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+  0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+  0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+  0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+  0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+  0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+  0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+#define __JSON_ROR(x, n)  ( ((x) >> (n)) | ((x) << (32 - (n))) )
+
+inline JsonConfigHmac::JsonConfigHmac(const uint8_t* aKey, size_t aKeyLen) {
+  uint8_t k[64];
+
+  memset(k, 0, 64);
+  if ( aKeyLen > 64 ) {   // long keys are hashed first
+    begin();
+    update(aKey, aKeyLen);
+    end(k);
+  }
+  else {
+    memcpy(k, aKey, aKeyLen);
+  }
+  for (uint8_t i = 0; i < 64; i++) {
+    iPad[i] = k[i] ^ 0x5c;
+    k[i] ^= 0x36;
+  }
+  begin();
+  update(k, 64);
+}
+
+inline JsonConfigHmac::~JsonConfigHmac() {}
+
+inline size_t JsonConfigHmac::write(const uint8_t* aData, size_t aLen) {
+  update(aData, aLen);
+  return aLen;
+}
+
+inline void JsonConfigHmac::finish(uint8_t* aMac) {
+  uint8_t inner[JSON_HMAC_LEN];
+
+  end(inner);
+  begin();
+  update(iPad, 64);
+  update(inner, JSON_HMAC_LEN);
+  end(aMac);
+}
+
+inline void JsonConfigHmac::begin() {
+  static const uint32_t h0[8] = { 0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19 };
+  memcpy(iState, h0, sizeof(iState));
+  iFill = 0;
+  iTotal = 0;
+}
+
+inline void JsonConfigHmac::update(const uint8_t* aData, size_t aLen) {
+  iTotal += aLen;
+  while ( aLen ) {
+    size_t n = 64 - iFill;
+    if ( n > aLen ) n = aLen;
+    memcpy(iBlock + iFill, aData, n);
+    iFill += n;
+    aData += n;
+    aLen -= n;
+    if ( iFill == 64 ) {
+      block(iBlock);
+      iFill = 0;
+    }
+  }
+}
+
+inline void JsonConfigHmac::end(uint8_t* aHash) {
+  uint64_t bits = iTotal * 8;
+
+  iBlock[iFill++] = 0x80;
+  if ( iFill > 56 ) {
+    memset(iBlock + iFill, 0, 64 - iFill);
+    block(iBlock);
+    iFill = 0;
+  }
+  memset(iBlock + iFill, 0, 56 - iFill);
+  for (uint8_t i = 0; i < 8; i++) iBlock[63 - i] = (uint8_t) (bits >> (8 * i));
+  block(iBlock);
+
+  for (uint8_t i = 0; i < 8; i++) {
+    aHash[4 * i]     = (uint8_t) (iState[i] >> 24);
+    aHash[4 * i + 1] = (uint8_t) (iState[i] >> 16);
+    aHash[4 * i + 2] = (uint8_t) (iState[i] >> 8);
+    aHash[4 * i + 3] = (uint8_t) iState[i];
+  }
+}
+
+inline void JsonConfigHmac::block(const uint8_t* aBlock) {
+  uint32_t w[64];
+  uint32_t a, b, c, d, e, f, g, h;
+
+  for (uint8_t i = 0; i < 16; i++) {
+    w[i] = ((uint32_t) aBlock[4 * i] << 24) | ((uint32_t) aBlock[4 * i + 1] << 16) | ((uint32_t) aBlock[4 * i + 2] << 8) | aBlock[4 * i + 3];
+  }
+  for (uint8_t i = 16; i < 64; i++) {
+    uint32_t s0 = __JSON_ROR(w[i - 15], 7) ^ __JSON_ROR(w[i - 15], 18) ^ (w[i - 15] >> 3);
+    uint32_t s1 = __JSON_ROR(w[i - 2], 17) ^ __JSON_ROR(w[i - 2], 19) ^ (w[i - 2] >> 10);
+    w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+  }
+  a = iState[0]; b = iState[1]; c = iState[2]; d = iState[3];
+  e = iState[4]; f = iState[5]; g = iState[6]; h = iState[7];
+  for (uint8_t i = 0; i < 64; i++) {
+    uint32_t t1 = h + (__JSON_ROR(e, 6) ^ __JSON_ROR(e, 11) ^ __JSON_ROR(e, 25)) + ((e & f) ^ (~e & g)) + __jsonconfig_sha256_k[i] + w[i];
+    uint32_t t2 = (__JSON_ROR(a, 2) ^ __JSON_ROR(a, 13) ^ __JSON_ROR(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+    h = g; g = f; f = e; e = d + t1;
+    d = c; c = b; b = a; a = t1 + t2;
+  }
+  iState[0] += a; iState[1] += b; iState[2] += c; iState[3] += d;
+  iState[4] += e; iState[5] += f; iState[6] += g; iState[7] += h;
+}
+
+#endif
+
+
+//  Compares with a hex encoded MAC (either case) without an early exit on the first mismatch
+inline bool JsonConfigHmac::matches(const char* aHex) {
+  uint8_t mac[JSON_HMAC_LEN];
+  uint8_t diff = 0;
+
+  if ( aHex == NULL || strlen(aHex) != 2 * JSON_HMAC_LEN ) return false;
+  finish(mac);
+  for (uint8_t i = 0; i < JSON_HMAC_LEN; i++) {
+    uint8_t v = 0;
+    for (uint8_t j = 0; j < 2; j++) {
+      char c = aHex[2 * i + j];
+      v <<= 4;
+      if ( c >= '0' && c <= '9' ) v |= c - '0';
+      else if ( c >= 'a' && c <= 'f' ) v |= c - 'a' + 10;
+      else if ( c >= 'A' && c <= 'F' ) v |= c - 'A' + 10;
+      else return false;
+    }
+    diff |= v ^ mac[i];
+  }
+  return ( diff == 0 );
+}
+
+
+#endif // _JSONCONFIGHMAC_H_
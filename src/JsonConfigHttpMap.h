@@ -32,138 +32,18 @@ POSSIBILITY OF SUCH DAMAGE.
 #define _JSONCONFIGHTTPMAP_H_
 
 
-#include <JsonConfigBase.h>
-
-#if defined( ARDUINO_ARCH_ESP8266 )
-#include <WiFiClient.h>
-#include <ESP8266HTTPClient.h>
-#endif
-
-#if defined( ARDUINO_ARCH_ESP32 )
-#include <WiFiClient.h>
-#include <HTTPClient.h>
-#endif
-
-
-#define JSON_HTTPERR  (-97)
-#define JSON_NOWIFI   (-98)
+#include <JsonConfig.h>
+#include <JsonConfigHttpSource.h>
 
 
-class JsonConfigHttpMap : public JsonConfigBase {
-  public:
-    JsonConfigHttpMap();
-    virtual ~JsonConfigHttpMap();
-    
-    int8_t   parse(const String aUrl, char** aMap, int aNum);
-    int8_t   parse(const String aHost, uint16_t aPort, String aUrl, char** aMap, int aNum);
-        
-  protected:
-    virtual int8_t  _storeKeyValue(const char* aKey, const char* aValue);
-    virtual int8_t  _doParse(Stream& aJson, uint16_t aNum) { return JsonConfigBase::_doParse(aJson, aNum); };
-    
-  private:
-    int8_t          parseCommon(int aHttpResult, int aNum);
+//  Config from an HTTP server into an array of value buffers, in order of appearance
+typedef JsonConfig<JsonConfigHttpSource, JsonConfigMapSink>  JsonConfigHttpMap;
 
-    char**          iMap;
-    HTTPClient      iHttp;
-    // String          iPayload;
-    // size_t          iIndex;
-    size_t          iParamIndex;
-};
-
-#ifndef _JSONCONFIG_NOSTATIC
-static JsonConfigHttpMap JSONConfig;
-#endif 
-
-JsonConfigHttpMap::JsonConfigHttpMap() {}
-JsonConfigHttpMap::~JsonConfigHttpMap() {}
-
-
-int8_t JsonConfigHttpMap::parse(const String aHost, uint16_t aPort, const String aUrl, char** aMap, int aNum) {
-    int8_t rc;
-    WiFiClient      client;
-    
-    if (WiFi.status() != WL_CONNECTED) return JSON_NOWIFI;
-#ifdef _LIBDEBUG_
-    Serial.printf("JsonConfig: Connecting to: %s\n", aUrl.c_str());
+#if !defined( _JSONCONFIG_NOSTATIC )
+#if defined( JSONConfig )
+#error "JSONConfig is already defined by another JsonConfig header: include only one of them, or compile with _JSONCONFIG_NOSTATIC and use JsonConfigHttpMap::instance()"
 #endif
-    iMap = aMap;
-    rc = parseCommon( iHttp.begin(client, aHost, aPort, aUrl), aNum );
-    iHttp.end();
-    return rc;
-}
-
-
-
-int8_t JsonConfigHttpMap::parse(const String aUrl, char** aMap, int aNum) {
-    int8_t rc;
-    WiFiClient      client;
-
-    if (WiFi.status() != WL_CONNECTED) return JSON_NOWIFI;
-#ifdef _LIBDEBUG_
-    Serial.printf("JsonConfig: Connecting to: %s\n", aUrl.c_str());
-#endif
-    iMap = aMap;
-    rc = parseCommon( iHttp.begin(client, aUrl), aNum );
-    iHttp.end();
-#ifdef _LIBDEBUG_
-    Serial.printf("JsonConfigHttpMap::parse rc %d\n", rc );
-#endif 
-    return rc;
-}
-
-
-int8_t JsonConfigHttpMap::parseCommon(int aHttpResult, int aNum) {
-    int8_t rc;
-  
-    if ( aHttpResult ) {
-        int httpCode = iHttp.GET();
-#ifdef _LIBDEBUG_
-            Serial.printf("JsonConfig: Connected httpCode= %d\n", httpCode );
+#define JSONConfig  (JsonConfigHttpMap::instance())
 #endif
-        if (httpCode > 0) {
-            if (httpCode == HTTP_CODE_OK || httpCode == HTTP_CODE_MOVED_PERMANENTLY) {
-                // iPayload = iHttp.getString();
-                // iIndex = 0;
-                iParamIndex = 0;
-                rc = _doParse(iHttp.getStream(), aNum);
-#ifdef _LIBDEBUG_
-            Serial.printf("JsonConfigHttpMap::parseCommon rc %d\n", rc );
-#endif                
-                return rc;
-            }
-        }
-        else {
-            return httpCode;
-        }
-        return JSON_ERR;  // should never get here anyway - but stupid compiler complains. 
-    }
-    else {
-        return JSON_HTTPERR;
-    }
-    return JSON_ERR;  // should never get here anyway - but stupid compiler complains. 
-}
-
-/* 
-int16_t JsonConfigHttpMap::_nextChar() {
-    if (iIndex < iPayload.length() ) {
-        return (int16_t) iPayload[iIndex++];
-    }
-    else {
-        return JSON_EOF;
-    }
-}
- */
-
-int8_t  JsonConfigHttpMap::_storeKeyValue(const char* aKey, const char* aValue){
-#ifdef _LIBDEBUG_
-    Serial.printf("JsonConfigHttpMap::_storeKeyValue: %s:%s\n", aKey, aValue );
-//    Serial.printf("iMap base address: %u, iMap[iParamIndex] address: %u\n", (uint32_t)iMap, (uint32_t)iMap[iParamIndex]);
-#endif
-
-    strcpy(iMap[iParamIndex++], aValue);
-//    memcpy(iMap[iParamIndex++], aValue, strlen(aValue)+1);
-    return JSON_OK;
-}
 
-#endif // _JSONCONFIGHTTPMAP_H_
\ No newline at end of file
+#endif // _JSONCONFIGHTTPMAP_H_
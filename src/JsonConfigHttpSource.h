@@ -0,0 +1,205 @@
+/*
+Copyright (c) 2015-2020, Anatoli Arkhipenko.
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its contributors
+   may be used to endorse or promote products derived from this software without
+   specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef _JSONCONFIGHTTPSOURCE_H_
+#define _JSONCONFIGHTTPSOURCE_H_
+
+
+#include <JsonConfig.h>
+#include <JsonConfigCache.h>
+#include <JsonConfigHmac.h>
+#include <ParametersPool.h>
+
+#if defined( ARDUINO_ARCH_ESP8266 )
+#include <WiFiClient.h>
+#include <ESP8266HTTPClient.h>
+#endif
+
+#if defined( ARDUINO_ARCH_ESP32 )
+#include <WiFiClient.h>
+#include <HTTPClient.h>
+#endif
+
+
+#define JSON_HTTPERR  (-97)
+#define JSON_NOWIFI   (-98)
+#define JSON_AUTH     (-26)
+
+#ifndef JSON_HMAC_HEADER
+#define JSON_HMAC_HEADER  "X-Config-HMAC"   // hex encoded HMAC-SHA256 of the response body
+#endif
+
+#ifndef JSON_HTTP_DRAIN
+#define JSON_HTTP_DRAIN   2000L   // ms to wait for the rest of a body that is cached or verified
+#endif
+
+
+//  Source policy of JsonConfig: config downloaded with an HTTP GET,
+//  optionally cached in a file and verified against an HMAC header
+class JsonConfigHttpSource {
+  public:
+    JsonConfigHttpSource();
+
+    inline void cache(const String& aPath, fs::FS& aFS) { iCache = aPath; iCacheFS = &aFS; };
+    inline void verify(const char* aKey, const char* aHeader = JSON_HMAC_HEADER) { iHmacKey = aKey; iHmacHeader = aHeader; };
+
+  protected:
+    template <class P>
+    int8_t          _fetch(const String& aUrl, P& aRun);
+    template <class P>
+    int8_t          _fetch(const String& aHost, uint16_t aPort, const String& aUrl, P& aRun);
+
+  private:
+    template <class P>
+    int8_t          _get(bool aBegin, P& aRun);
+    template <class P>
+    int8_t          _getVerified(P& aRun, JsonConfigStaged);
+    template <class P>
+    inline int8_t   _getVerified(P& aRun, JsonConfigUnstaged) { return JSON_AUTH; };  // not reached: verify() does not compile for these sinks
+    int8_t          _drain(JsonConfigCache& aCache);
+
+    HTTPClient      iHttp;
+    String          iCache;
+    fs::FS*         iCacheFS;
+    const char*     iHmacKey;
+    const char*     iHmacHeader;
+};
+
+
+inline JsonConfigHttpSource::JsonConfigHttpSource() {
+    iCacheFS = NULL;
+    iHmacKey = NULL;
+    iHmacHeader = JSON_HMAC_HEADER;
+}
+
+
+template <class P>
+int8_t JsonConfigHttpSource::_fetch(const String& aHost, uint16_t aPort, const String& aUrl, P& aRun) {
+    int8_t rc;
+    WiFiClient      client;
+
+    if (WiFi.status() != WL_CONNECTED) return JSON_NOWIFI;
+#ifdef _LIBDEBUG_
+    Serial.printf("JsonConfig: Connecting to: %s\n", aUrl.c_str());
+#endif
+    rc = _get( iHttp.begin(client, aHost, aPort, aUrl), aRun );
+    iHttp.end();
+    return rc;
+}
+
+
+template <class P>
+int8_t JsonConfigHttpSource::_fetch(const String& aUrl, P& aRun) {
+    int8_t rc;
+    WiFiClient      client;
+
+    if (WiFi.status() != WL_CONNECTED) return JSON_NOWIFI;
+#ifdef _LIBDEBUG_
+    Serial.printf("JsonConfig: Connecting to: %s\n", aUrl.c_str());
+#endif
+    rc = _get( iHttp.begin(client, aUrl), aRun );
+    iHttp.end();
+    return rc;
+}
+
+
+template <class P>
+int8_t JsonConfigHttpSource::_get(bool aBegin, P& aRun) {
+    int8_t rc;
+
+    if ( !aBegin ) return JSON_HTTPERR;
+    if ( iHmacKey ) {
+        const char* hdrs[] = { iHmacHeader };
+        iHttp.collectHeaders(hdrs, 1);
+    }
+    int httpCode = iHttp.GET();
+        // httpCode will be negative on error
+#ifdef _LIBDEBUG_
+    Serial.printf("JsonConfig: httpCode = %d\n", httpCode);
+#endif
+    if ( httpCode <= 0 ) return httpCode;
+    if ( httpCode != HTTP_CODE_OK && httpCode != HTTP_CODE_MOVED_PERMANENTLY ) return JSON_ERR;
+    if ( iHmacKey ) return _getVerified(aRun, typename P::Staging());
+
+    JsonConfigCache cache(iCache, iHttp.getStream(), iCacheFS);
+    rc = aRun(cache.stream());
+    if ( rc == JSON_OK && cache.active() && _drain(cache) != JSON_OK ) {
+        cache.commit(false);    // values are parsed, but the body is not complete: keep the last good file
+        return rc;
+    }
+    cache.commit(rc == JSON_OK);
+    return rc;
+}
+
+
+//  Signed config: the body is authenticated while it is parsed, values are staged
+//  and reach the sink (and the cache file) only if the MAC matches
+template <class P>
+int8_t JsonConfigHttpSource::_getVerified(P& aRun, JsonConfigStaged) {
+    String mac = iHttp.header(iHmacHeader);
+    if ( mac.length() == 0 ) return JSON_AUTH;
+
+    JsonConfigHmac  hmac((const uint8_t*) iHmacKey, strlen(iHmacKey));
+    JsonConfigTee   tee(iHttp.getStream(), hmac);
+    JsonConfigCache cache(iCache, tee, iCacheFS);
+    ParametersDictionary stage;
+
+    int8_t rc = aRun.stage(cache.stream(), stage);
+    if ( rc == JSON_OK ) {
+        _drain(cache);          // the MAC covers the whole body
+        tee.flush();
+        if ( !hmac.matches(mac.c_str()) ) rc = JSON_AUTH;
+    }
+#ifdef _LIBDEBUG_
+    Serial.printf("JsonConfigHttpSource::_getVerified: rc = %d\n", rc);
+#endif
+    cache.commit(rc == JSON_OK);
+    if ( rc == JSON_OK ) rc = aRun.apply(stage);
+    return rc;
+}
+
+//  Reads the rest of the body: parsing may stop early (aNum values), but the cache file
+//  and the MAC have to cover all of it. Returns JSON_EOF if the body ended before its Content-Length
+inline int8_t JsonConfigHttpSource::_drain(JsonConfigCache& aCache) {
+    Stream& in = aCache.stream();
+    int size = iHttp.getSize();     // -1 if not known (chunked transfer)
+    uint32_t t = millis();
+
+    for (;;) {
+        if ( in.read() >= 0 ) continue;
+        if ( size < 0 || !aCache.active() || aCache.length() >= (size_t) size ) break;
+        if ( millis() - t > JSON_HTTP_DRAIN ) break;
+        yield();
+    }
+    if ( size >= 0 && aCache.active() && aCache.length() < (size_t) size ) return JSON_EOF;
+    return JSON_OK;
+}
+
+#endif // _JSONCONFIGHTTPSOURCE_H_
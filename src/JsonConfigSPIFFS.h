@@ -32,79 +32,18 @@
 #define _JSONCONFIGSPIFFS_H_
 
 
-#include <JsonConfigBase.h>
-#include <Dictionary.h>
+#include <JsonConfig.h>
+#include <JsonConfigFileSource.h>
 
-#if defined( ARDUINO_ARCH_ESP8266 )
-#include <FS.h>
-#endif
-
-#if defined( ARDUINO_ARCH_ESP32 )
-#include <FS.h>
-#include <SPIFFS.h>
-#endif
-
-#define JSON_FILERR  (-95)
-#define JSON_FILENE  (-96)
 
-class JsonConfigSPIFFS : public JsonConfigBase {
-  public:
-    JsonConfigSPIFFS();
-    virtual ~JsonConfigSPIFFS();
+//  Config file on SPIFFS into a dictionary
+typedef JsonConfig<JsonConfigFileSource, JsonConfigDictSink>  JsonConfigSPIFFS;
 
-    int8_t   parse(const String aUrl, Dictionary& aDict, int aNum = 0);
-
-  protected:
-    virtual int8_t  _storeKeyValue(const char* aKey, const char* aValue);
-    virtual int8_t  _doParse(Stream& aJson, uint16_t aNum) { return JsonConfigBase::_doParse(aJson, aNum); };
-    
-  private:
-    Dictionary*     iDict;
-    File            iF;
-};
-
-#ifndef _JSONCONFIG_NOSTATIC
-static JsonConfigSPIFFS JSONConfig;
+#if !defined( _JSONCONFIG_NOSTATIC )
+#if defined( JSONConfig )
+#error "JSONConfig is already defined by another JsonConfig header: include only one of them, or compile with _JSONCONFIG_NOSTATIC and use JsonConfigSPIFFS::instance()"
 #endif
-
-JsonConfigSPIFFS::JsonConfigSPIFFS() {
-  //  SPIFFS.begin();
-}
-
-JsonConfigSPIFFS::~JsonConfigSPIFFS() {
-  //  SPIFFS.end();
-}
-
-int8_t JsonConfigSPIFFS::parse(const String aUrl, Dictionary& aDict, int aNum) {
-  int8_t rc; 
-  
-  if ( !SPIFFS.exists(aUrl) ) { // || !SPIFFS.isFile(aUrl) ) {
-    return JSON_FILENE;
-  }
-
-  iF = SPIFFS.open(aUrl, "r");
-  if ( !iF ) {
-    return JSON_FILERR;
-  }
-
-  iDict = &aDict;
-  rc = _doParse ( iF, aNum );
-  
-  iF.close();
-  return rc;
-}
-
-
-// int16_t    JsonConfigSPIFFS::_nextChar() {
-    // return (int16_t) iF.read();
-// }
-
-
-int8_t  JsonConfigSPIFFS::_storeKeyValue(const char* aKey, const char* aValue){
-#ifdef _LIBDEBUG_
-    Serial.printf("JsonConfigSPIFFS::_storeKeyValue: %s:%s\n", aKey, aValue );
+#define JSONConfig  (JsonConfigSPIFFS::instance())
 #endif
-    return iDict->insert(aKey, aValue);
-}
 
-#endif // _JSONCONFIGSPIFFS_H_
\ No newline at end of file
+#endif // _JSONCONFIGSPIFFS_H_
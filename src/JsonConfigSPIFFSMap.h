@@ -32,75 +32,18 @@ POSSIBILITY OF SUCH DAMAGE.
 #define _JSONCONFIGSPIFFSMAP_H_
 
 
-#include <JsonConfigBase.h>
-
-#if defined( ARDUINO_ARCH_ESP8266 )
-#include <FS.h>
-#endif
-
-#if defined( ARDUINO_ARCH_ESP32 )
-#include <FS.h>
-#include <SPIFFS.h>
-#endif
+#include <JsonConfig.h>
+#include <JsonConfigFileSource.h>
 
 
-#define JSON_FILERR  (-95)
-#define JSON_FILENE  (-96)
+//  Config file on SPIFFS into an array of value buffers, in order of appearance
+typedef JsonConfig<JsonConfigFileSource, JsonConfigMapSink>  JsonConfigSPIFFSMap;
 
-
-class JsonConfigSPIFFSMap : public JsonConfigBase {
-  public:
-    JsonConfigSPIFFSMap();
-    virtual ~JsonConfigSPIFFSMap();
-    
-    int8_t   parse(const String aUrl, char** aMap, int aNum);
-    
-  protected:
-    virtual int8_t  _storeKeyValue(const char* aKey, const char* aValue);
-    virtual int8_t  _doParse(Stream& aJson, uint16_t aNum) { return JsonConfigBase::_doParse(aJson, aNum); };
-        
-  private:
-    char**          iMap;
-    File            iF;
-    size_t          iParamIndex;
-};
-
-#ifndef _JSONCONFIG_NOSTATIC
-static JsonConfigSPIFFSMap JSONConfig;
+#if !defined( _JSONCONFIG_NOSTATIC )
+#if defined( JSONConfig )
+#error "JSONConfig is already defined by another JsonConfig header: include only one of them, or compile with _JSONCONFIG_NOSTATIC and use JsonConfigSPIFFSMap::instance()"
+#endif
+#define JSONConfig  (JsonConfigSPIFFSMap::instance())
 #endif
 
-JsonConfigSPIFFSMap::JsonConfigSPIFFSMap() {}
-JsonConfigSPIFFSMap::~JsonConfigSPIFFSMap() {}
-
-int8_t JsonConfigSPIFFSMap::parse(const String aUrl, char** aMap, int aNum) {
-  int8_t rc; 
-  
-  if ( !SPIFFS.exists(aUrl) ) { // || !SPIFFS.isFile(aUrl) ) {
-    return JSON_FILENE;
-  }
-
-  iF = SPIFFS.open(aUrl, "r");
-  if ( !iF ) {
-    return JSON_FILERR;
-  }
-
-  iMap = aMap;
-  iParamIndex = 0;
-  rc = _doParse ( iF, aNum );
-  
-  iF.close();
-  return rc;
-}
-
-
-// char    JsonConfigSPIFFSMap::_nextChar() {
-    // return (int16_t) iF.read();
-// }
-
-
-int8_t  JsonConfigSPIFFSMap::_storeKeyValue(const char* aKey, const char* aValue){
-    strcpy(iMap[iParamIndex++], aValue);
-    return JSON_OK;
-}
-
-#endif // _JSONCONFIGSPIFFSMAP_H_
\ No newline at end of file
+#endif // _JSONCONFIGSPIFFSMAP_H_
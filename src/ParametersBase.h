@@ -33,6 +33,10 @@
 
 #include <Arduino.h>
 
+#if defined( ARDUINO_ARCH_ESP8266 ) || defined( ARDUINO_ARCH_ESP32 )
+#include <EEPROM.h>
+#endif
+
 // Error codes:
 #define PARAMS_OK   0
 #define PARAMS_ERR  (-1)
@@ -40,13 +44,56 @@
 #define PARAMS_CRC  (-3)
 #define PARAMS_TOK  (-4)
 #define PARAMS_FDE  (-5)
+#define PARAMS_FMT  (-7)
+#define PARAMS_KEY  (-8)
 #define PARAMS_MEM  (-98)
 #define PARAMS_ACT  (-99)
 
 
-class ParametersBase {
+//  Identifies stored parameters. A literal is taken as a pointer and should outlive the
+//  parameters object. A String is copied, except in _PARAMS_NOSTRING builds, where it is
+//  referenced as well and a temporary String is rejected at compile time
+class ParametersToken {
   public:
-    ParametersBase(const String& aToken);
+    ParametersToken(const char* aToken) { iToken = aToken; };
+#if defined( _PARAMS_NOSTRING )
+    ParametersToken(const String& aToken) { iToken = aToken.c_str(); };
+    ParametersToken(String&& aToken) = delete;
+#else
+    ParametersToken(const String& aToken) : iCopy(aToken) { iToken = NULL; };
+#endif
+
+#if defined( _PARAMS_NOSTRING )
+    inline const char*  c_str() const { return iToken; };
+#else
+    inline const char*  c_str() const { return iToken ? iToken : iCopy.c_str(); };
+#endif
+    inline size_t       length() const { return strlen( c_str() ); };
+
+  private:
+    const char*     iToken;
+#if !defined( _PARAMS_NOSTRING )
+    String          iCopy;
+#endif
+};
+
+
+//  Batch state shared by all parameter objects. A class template, so the static members
+//  could be defined in this header and still exist once in a multi-file sketch
+template<class T>
+class ParametersBatch {
+  protected:
+    static uint8_t  iBatch;
+    static int8_t   (*iBatchCommit)();
+};
+
+template<class T> uint8_t ParametersBatch<T>::iBatch = 0;
+template<class T> int8_t  (*ParametersBatch<T>::iBatchCommit)() = NULL;
+
+
+class ParametersBase : public ParametersBatch<void> {
+  public:
+    ParametersBase(const ParametersToken& aToken);
     virtual ~ParametersBase();
 
     virtual int8_t          begin() = 0;
@@ -57,15 +104,69 @@ class ParametersBase {
       return iActive;
     };
 
+    inline const ParametersToken& token() {
+      return iToken;
+    };
+
+    //  Batch saves of several parameter objects into a single storage commit
+    static void     beginBatch();
+    static int8_t   commitBatch();
+    static inline bool inBatch() {
+      return iBatch > 0;
+    };
+
   protected:
+    static int8_t   commitEEPROM();
+
     int8_t          iActive;
-    const String&   iToken;
+    ParametersToken iToken;
+
+  private:
+    static int8_t   _commitEEPROM();
 };
 
-ParametersBase::ParametersBase(const String& aToken) : iToken(aToken) {
+inline ParametersBase::ParametersBase(const ParametersToken& aToken) : iToken(aToken) {
   iActive = false;
 }
 
-ParametersBase::~ParametersBase () {}
+inline ParametersBase::~ParametersBase () {}
+
+
+//  Batches could be nested, storage is committed when the outermost batch is committed
+inline void ParametersBase::beginBatch() {
+  iBatch++;
+}
+
+
+inline int8_t ParametersBase::commitBatch() {
+  int8_t rc = PARAMS_OK;
+
+  if ( iBatch == 0 ) return PARAMS_OK;
+  if ( --iBatch > 0 ) return PARAMS_OK;
+
+  if ( iBatchCommit ) {
+    rc = iBatchCommit();
+    iBatchCommit = NULL;
+  }
+  return rc;
+}
+
+
+//  EEPROM emulated in flash is written out on commit: within a batch it is left to commitBatch()
+inline int8_t ParametersBase::commitEEPROM() {
+  if ( inBatch() ) {
+    iBatchCommit = _commitEEPROM;
+    return PARAMS_OK;
+  }
+  return _commitEEPROM();
+}
+
+
+inline int8_t ParametersBase::_commitEEPROM() {
+#if defined( ARDUINO_ARCH_ESP8266 ) || defined( ARDUINO_ARCH_ESP32 )
+  if ( !EEPROM.commit() ) return PARAMS_ERR;
+#endif
+  return PARAMS_OK;
+}
 
 #endif // _PARAMETERSBASE_H_
\ No newline at end of file
@@ -32,8 +32,15 @@
 */
 
 #include <ParametersBase.h>
-#include <Dictionary.h>
+#include <ParametersPool.h>
 #include <EEPROM.h>
+#ifdef _PARAMS_COMPRESS
+#include <ParametersLZ.h>
+#endif
+
+#if defined( _PARAMS_COMPRESS ) && defined( _PARAMS_INDEX )
+#error "_PARAMS_COMPRESS and _PARAMS_INDEX are mutually exclusive: compressed image cannot be indexed"
+#endif
 
 #ifndef EEPROM_MAX
 
@@ -51,50 +58,131 @@
 
 #endif // #ifndef EEPROM_MAX
 
+#define CRCMASK 0x1d
+
+// Extended image header (follows the token in place of the pair count):
+//  2 bytes marker, 1 byte codec, 2 bytes uncompressed length, 2 bytes stored length
+#define PARAMS_EXT_MARK   0xFFFF
+#define PARAMS_EXT_HDR    7
+#define PARAMS_CODEC_LZ   1
+#define PARAMS_CODEC_IDX  2   // raw pairs followed by a key-sorted table of 2-byte pair offsets
+
+#ifdef _PARAMS_RTC
+// RTC memory copy of parameters survives deep sleep: wake up without touching the flash
+// Layout: 4 bytes magic, 4 bytes crc32 of the token, 4 bytes crc32, 2 bytes length, 2 bytes reserved, token and pairs
+#define PARAMS_RTC_MAGIC  0x45425254UL
+#define PARAMS_RTC_HDR    16
+
+#ifndef PARAMS_RTC_OFFSET
+#define PARAMS_RTC_OFFSET 32      // in 4-byte blocks from the start of user RTC memory: first 128 bytes are left to the sketch
+#endif
+
+#ifndef PARAMS_RTC_SIZE
+#define PARAMS_RTC_SIZE   256     // half of ESP8266 user RTC memory, the last 128 bytes are left to the sketch as well
+#endif
+
+#define PARAMS_RTC_AREA   512     // user RTC memory available to rtc() areas (ESP8266), or reserved by the stand-in
+
+#if PARAMS_RTC_OFFSET * 4 + PARAMS_RTC_SIZE > PARAMS_RTC_AREA
+#error "PARAMS_RTC_OFFSET and PARAMS_RTC_SIZE exceed user RTC memory"
+#endif
+
+#ifndef RTC_NOINIT_ATTR
+#define RTC_NOINIT_ATTR
+#endif
+
+#if !defined( ARDUINO_ARCH_ESP8266 )
+//  ESP32 keeps uninitialized RTC slow memory through deep sleep, elsewhere it is a plain RAM stand-in.
+//  One area for the whole sketch, whichever file includes this header
+inline uint32_t* __params_rtc() {
+  static RTC_NOINIT_ATTR uint32_t rtc[PARAMS_RTC_AREA / 4];
+  return rtc;
+}
+#endif
+#endif // _PARAMS_RTC
+
 class ParametersEEPROM : public ParametersBase {
 public:
-  ParametersEEPROM(const String & aToken, Dictionary & aDict, uint16_t aAddress, uint16_t aSize ) ;
+  ParametersEEPROM(const ParametersToken& aToken, ParametersDictionary & aDict, uint16_t aAddress, uint16_t aSize ) ;
   virtual ~ParametersEEPROM();
 
   virtual int8_t  begin();
   virtual int8_t  load();
   virtual int8_t  save();
   
+  int8_t          get(const char* aKey, char* aBuf, uint16_t aCap);
   void            clear();
+#ifdef _PARAMS_RTC
+  int8_t          rtc(uint16_t aOffset, uint16_t aSize);
+#endif
 
 private:
   uint8_t         checksum ();
+  int8_t          verify();
+  uint16_t        read16(uint16_t aAddr);
+  int8_t          compare(uint16_t aAddr, const char* aKey);
+  uint16_t        pack(uint8_t* aDst);
+  void            unpack(const uint8_t* aSrc);
+  void            beginEEPROM();
+#ifdef _PARAMS_RTC
+  int8_t          loadRTC();
+  void            saveRTC();
+  static uint32_t crc32(const uint8_t* aData, uint16_t aLen);
+  void            readRTC(uint16_t aOffset, uint32_t* aData, uint16_t aLen);
+  void            writeRTC(uint16_t aOffset, uint32_t* aData, uint16_t aLen);
+#endif
+#ifdef _PARAMS_COMPRESS
+  int8_t          loadCompressed(const uint8_t* aHdr);
+#endif
 
-  Dictionary&     iDict;
+  ParametersDictionary& iDict;
   uint16_t        iAddress;
   uint8_t*        iData;
   uint16_t        iSize;
+  bool            iVerified;
+  bool            iEEPROM;
+#ifdef _PARAMS_RTC
+  uint16_t        iRtcOffset;
+  uint16_t        iRtcSize;
+#endif
 };
 
-ParametersEEPROM::ParametersEEPROM(const String& aToken, Dictionary& aDict, uint16_t aAddress, uint16_t aSize ) : ParametersBase(aToken), iDict(aDict)  {
+inline ParametersEEPROM::ParametersEEPROM(const ParametersToken& aToken, ParametersDictionary& aDict, uint16_t aAddress, uint16_t aSize ) : ParametersBase(aToken), iDict(aDict)  {
   iActive = false;
   iAddress = aAddress;
   iSize = aSize;
   iData = NULL;
+  iVerified = false;
+  iEEPROM = false;
+#ifdef _PARAMS_RTC
+  iRtcOffset = PARAMS_RTC_OFFSET;
+  iRtcSize = PARAMS_RTC_SIZE;
+#endif
 }
 
 
-ParametersEEPROM::~ParametersEEPROM() {
+inline ParametersEEPROM::~ParametersEEPROM() {
   if (iActive) {
     save();
 #if defined( ARDUINO_ARCH_ESP8266 ) || defined( ARDUINO_ARCH_ESP32 )
-    EEPROM.end();
+    // EEPROM.end() commits and releases the buffer shared by all objects:
+    // within a batch this is left to commitBatch()
+    if ( !inBatch() && iEEPROM ) EEPROM.end();
 #endif
     iActive = false;
   }
 }
 
 
-int8_t ParametersEEPROM::begin() {
+inline int8_t ParametersEEPROM::begin() {
+#ifdef _PARAMS_COMPRESS
+  uint16_t maxLen = iToken.length() + PARAMS_EXT_HDR + 2; // actual fit is only known after compression in save()
+#else
   uint16_t maxLen = iToken.length() + iDict.esize() + 4; // 4: 1 null for token, 1 crc8, 2 bytes for count
+#endif
   if ( iSize < EEPROM_MAX && maxLen <= iSize) {
-#if defined( ARDUINO_ARCH_ESP8266 ) || defined( ARDUINO_ARCH_ESP32 )
-    EEPROM.begin(4096); // allocate all memory
+#ifndef _PARAMS_RTC
+    beginEEPROM();  // with RTC copy EEPROM is only allocated if flash has to be accessed
 #endif
     iActive = true;
     return PARAMS_OK;
@@ -105,13 +193,18 @@ int8_t ParametersEEPROM::begin() {
 }
 
 
-int8_t ParametersEEPROM::load() {
+inline int8_t ParametersEEPROM::load() {
   uint16_t iTl = iToken.length();
 
   if (!iActive) {
     return PARAMS_ACT;
   }
 
+#ifdef _PARAMS_RTC
+  if ( loadRTC() == PARAMS_OK ) return PARAMS_OK;
+  beginEEPROM();
+#endif
+
   iData = (uint8_t * ) malloc(iSize);
   if (iData == NULL) {
     //    iRc = PARAMS_MEM;
@@ -125,6 +218,7 @@ int8_t ParametersEEPROM::load() {
   uint8_t crc = EEPROM.read( iAddress + iSize - 1);
 
   // Check CRC
+  iVerified = false;
   if (crc != checksum () ) {
     free(iData);
     iData = NULL;
@@ -142,18 +236,31 @@ int8_t ParametersEEPROM::load() {
   p = iData + (iTl + 1);
 
   uint16_t cnt = *p | ((((uint16_t) * (p + 1)) << 8) & 0xff00);
-  p += 2;
-
-  for (uint16_t i = 0; i < cnt; i++) {
-    String k = String((char* )p);
-    p += (k.length() + 1);
-    String v = String((char* )p);
-    p += (v.length() + 1);
-    iDict(k, v);
+  iVerified = true;
+  if ( cnt == PARAMS_EXT_MARK && p[2] == PARAMS_CODEC_IDX ) {
+    // indexed image: pairs are stored in the regular layout, index is not needed for a full load
+    p += PARAMS_EXT_HDR;
+  }
+  else if ( cnt == PARAMS_EXT_MARK ) {
+#ifdef _PARAMS_COMPRESS
+    int8_t rc = loadCompressed(p + 2);
+#else
+    int8_t rc = PARAMS_FMT;
+#endif
+    free(iData);
+    iData = NULL;
+#ifdef _PARAMS_RTC
+    if ( rc == PARAMS_OK ) saveRTC();
+#endif
+    return rc;
   }
+  unpack(p);
 
   free(iData);
   iData = NULL;
+#ifdef _PARAMS_RTC
+  saveRTC();
+#endif
   return PARAMS_OK;
   //  if ( iMode == PARAMS_FILE ) {
   //    String file = "/" + iToken + ".json";
@@ -164,20 +271,27 @@ int8_t ParametersEEPROM::load() {
 }
 
 
-int8_t ParametersEEPROM::save() {
+inline int8_t ParametersEEPROM::save() {
   uint8_t changed = 0;
   int8_t  rc = PARAMS_OK;
   
   if (!iActive) {
     return PARAMS_ACT;
   }
+  beginEEPROM();
 
   uint16_t iTl = iToken.length();
   uint16_t iDs = iDict.esize();
-  uint16_t iDc = iDict.count();
   uint16_t maxLen = iTl + iDs + 4;
 
+#if defined( _PARAMS_COMPRESS )
+  if ( iTl + PARAMS_EXT_HDR + 2 >= iSize ) {
+#elif defined( _PARAMS_INDEX )
+  maxLen += PARAMS_EXT_HDR + 2 * iDict.count();
   if ( maxLen >= iSize ) {
+#else
+  if ( maxLen >= iSize ) {
+#endif
     return PARAMS_LEN;
   }
   iData = (uint8_t * ) malloc(iSize);
@@ -190,7 +304,6 @@ int8_t ParametersEEPROM::save() {
 #ifdef _LIBDEBUG_
   Serial.println ("Parameters save: memory allocated and cleared");
   Serial.print("Token value: ");
-  Serial.println(iToken);
   Serial.println(iToken.c_str());
 #endif
 
@@ -201,20 +314,83 @@ int8_t ParametersEEPROM::save() {
   Serial.println ("Parameters save: token copied");
 #endif
 
-  *p++ = iDc & 0xff;
-  *p++ = (iDc >> 8) & 0xff;
-
-  for (uint16_t i = 0; i < iDc; i++) {
-    strcpy((char*)p, iDict(i).c_str());
-    p += (iDict(i).length() + 1);
-    strcpy((char*)p, iDict[i].c_str());
-    p += (iDict[i].length() + 1);
+#ifdef _PARAMS_COMPRESS
+  {
+    uint16_t rawLen = iDs + 2;
+    uint16_t room = iSize - 1 - (iTl + 1) - PARAMS_EXT_HDR;
+    uint8_t* raw = (uint8_t * ) malloc(rawLen);
+    if (raw == NULL) {
+      free(iData);
+      iData = NULL;
+      return PARAMS_MEM;
+    }
+    rawLen = pack(raw);
+
+    uint16_t zLen = ParametersLZ::compress(raw, rawLen, p + PARAMS_EXT_HDR, room);
+    if ( zLen > 0 && zLen + PARAMS_EXT_HDR < rawLen ) {
+      *p++ = PARAMS_EXT_MARK & 0xff;
+      *p++ = (PARAMS_EXT_MARK >> 8) & 0xff;
+      *p++ = PARAMS_CODEC_LZ;
+      *p++ = rawLen & 0xff;
+      *p++ = (rawLen >> 8) & 0xff;
+      *p++ = zLen & 0xff;
+      *p++ = (zLen >> 8) & 0xff;
+      memset(p + zLen, 0, room - zLen);
+    }
+    else if ( maxLen < iSize ) {
+      // compression does not help - store the raw image
+      memset(p, 0, iSize - 1 - (iTl + 1));
+      memcpy(p, raw, rawLen);
+    }
+    else {
+      free(raw);
+      free(iData);
+      iData = NULL;
+      return PARAMS_LEN;
+    }
+    free(raw);
 
 #ifdef _LIBDEBUG_
-    Serial.printf ("Parameters save: k-v pair #%d copies: %s : %s\n", i, iDict(i).c_str(), iDict[i].c_str());
+    Serial.printf ("Parameters save: raw length %u, compressed length %u\n", rawLen, zLen);
 #endif
-
   }
+#elif defined( _PARAMS_INDEX )
+  {
+    uint8_t* s = p + PARAMS_EXT_HDR;
+    uint16_t cnt = iDict.count();
+    uint16_t len = pack(s);
+    uint8_t* idx = s + len;
+    uint8_t* k = s + 2;
+
+    // insertion sort of pair offsets by key
+    for (uint16_t i = 0; i < cnt; i++) {
+      uint16_t off = k - s;
+      uint16_t j = i;
+      while ( j > 0 ) {
+        uint16_t o = idx[2 * (j - 1)] | ((((uint16_t) idx[2 * (j - 1) + 1]) << 8) & 0xff00);
+        if ( strcmp((const char*) (s + o), (const char*) k) <= 0 ) break;
+        idx[2 * j] = idx[2 * (j - 1)];
+        idx[2 * j + 1] = idx[2 * (j - 1) + 1];
+        j--;
+      }
+      idx[2 * j] = off & 0xff;
+      idx[2 * j + 1] = (off >> 8) & 0xff;
+      k += strlen((const char*) k) + 1;
+      k += strlen((const char*) k) + 1;
+    }
+    len += 2 * cnt;
+
+    *p++ = PARAMS_EXT_MARK & 0xff;
+    *p++ = (PARAMS_EXT_MARK >> 8) & 0xff;
+    *p++ = PARAMS_CODEC_IDX;
+    *p++ = len & 0xff;
+    *p++ = (len >> 8) & 0xff;
+    *p++ = len & 0xff;
+    *p++ = (len >> 8) & 0xff;
+  }
+#else
+  pack(p);
+#endif
 
 #ifdef _LIBDEBUG_
   Serial.println ("Parameters save: Key-value pairs copied");
@@ -254,9 +430,7 @@ int8_t ParametersEEPROM::save() {
   }
 #endif
 #if defined( ARDUINO_ARCH_ESP8266 ) || defined( ARDUINO_ARCH_ESP32 )
-  if ( changed ) {
-    if ( !EEPROM.commit() ) rc = PARAMS_ERR; 
-  }
+  if ( changed && commitEEPROM() != PARAMS_OK ) rc = PARAMS_ERR;
 #endif
 
 #ifdef _LIBDEBUG_
@@ -266,6 +440,10 @@ int8_t ParametersEEPROM::save() {
 
   free(iData);
   iData = NULL;
+  iVerified = ( rc == PARAMS_OK );
+#ifdef _PARAMS_RTC
+  if ( rc == PARAMS_OK ) saveRTC();
+#endif
 
 #ifdef _LIBDEBUG_
   Serial.println ("Parameters save: memory freed");
@@ -276,15 +454,319 @@ int8_t ParametersEEPROM::save() {
 }
 
 
-void ParametersEEPROM::clear () {
+inline uint16_t ParametersEEPROM::pack(uint8_t* aDst) {
+  uint8_t* p = aDst;
+  uint16_t iDc = iDict.count();
+
+  *p++ = iDc & 0xff;
+  *p++ = (iDc >> 8) & 0xff;
+
+  for (uint16_t i = 0; i < iDc; i++) {
+    String k = iDict(i);
+    String v = iDict[i];
+    memcpy(p, k.c_str(), k.length() + 1);
+    p += (k.length() + 1);
+    memcpy(p, v.c_str(), v.length() + 1);
+    p += (v.length() + 1);
+
+#ifdef _LIBDEBUG_
+    Serial.printf ("Parameters save: k-v pair #%d copies: %s : %s\n", i, k.c_str(), v.c_str());
+#endif
+
+  }
+  return p - aDst;
+}
+
+
+//  Populates the dictionary from pair count followed by null-terminated keys and values
+inline void ParametersEEPROM::unpack(const uint8_t* aSrc) {
+  const uint8_t* p = aSrc;
+  uint16_t cnt = *p | ((((uint16_t) * (p + 1)) << 8) & 0xff00);
+  p += 2;
+
+  for (uint16_t i = 0; i < cnt; i++) {
+    const char* k = (const char*) p;
+    p += (strlen(k) + 1);
+    const char* v = (const char*) p;
+    p += (strlen(v) + 1);
+    iDict.insert(k, v);
+  }
+}
+
+
+inline void ParametersEEPROM::beginEEPROM() {
+  if ( !iEEPROM ) {
+#if defined( ARDUINO_ARCH_ESP8266 ) || defined( ARDUINO_ARCH_ESP32 )
+    EEPROM.begin(4096); // allocate all memory
+#endif
+    iEEPROM = true;
+  }
+}
+
+
+#ifdef _PARAMS_RTC
+inline int8_t ParametersEEPROM::loadRTC() {
+  uint32_t hdr[PARAMS_RTC_HDR / 4];
+
+  readRTC(0, hdr, PARAMS_RTC_HDR);
+  if ( hdr[0] != PARAMS_RTC_MAGIC ) return PARAMS_CRC;
+  //  the area may hold the image of another object: check whose it is before looking any further
+  if ( hdr[1] != crc32( (const uint8_t*) iToken.c_str(), iToken.length() ) ) return PARAMS_TOK;
+
+  uint16_t len = hdr[3] & 0xffff;
+  if ( len > iRtcSize - PARAMS_RTC_HDR || len < iToken.length() + 3 ) {
+    return PARAMS_CRC;
+  }
+
+  uint32_t* buf = (uint32_t*) malloc( (len + 3) & ~3 );
+  if ( buf == NULL ) return PARAMS_MEM;
+  readRTC(PARAMS_RTC_HDR / 4, buf, (len + 3) & ~3);
+
+  const uint8_t* p = (const uint8_t*) buf;
+  if ( crc32(p, len) != hdr[2] ) {
+    free(buf);
+    return PARAMS_CRC;
+  }
+  if ( strncmp( iToken.c_str(), (const char*) p, len ) != 0 ) {
+    free(buf);
+    return PARAMS_TOK;
+  }
+  unpack(p + iToken.length() + 1);
+  free(buf);
+
+#ifdef _LIBDEBUG_
+  Serial.printf ("Parameters load: %u bytes loaded from RTC memory\n", len);
+#endif
+  return PARAMS_OK;
+}
+
+
+//  Refreshes RTC copy, or invalidates it if parameters do not fit.
+//  A valid image of another token is left alone: objects sharing an area do not evict each other
+inline void ParametersEEPROM::saveRTC() {
+  uint16_t iTl = iToken.length();
+  uint16_t len = iTl + 1 + 2 + iDict.esize();
+  uint32_t tok = crc32( (const uint8_t*) iToken.c_str(), iTl );
+  uint32_t hdr[PARAMS_RTC_HDR / 4] = { 0, 0, 0, 0 };
+
+  readRTC(0, hdr, PARAMS_RTC_HDR);
+  if ( hdr[0] == PARAMS_RTC_MAGIC && hdr[1] != tok ) return;
+  memset(hdr, 0, PARAMS_RTC_HDR);
+
+  uint32_t* buf = NULL;
+  if ( len <= iRtcSize - PARAMS_RTC_HDR ) {
+    buf = (uint32_t*) malloc( (len + 3) & ~3 );
+  }
+  if ( buf ) {
+    uint8_t* p = (uint8_t*) buf;
+    memset(p, 0, (len + 3) & ~3);
+    strcpy((char*) p, iToken.c_str());
+    len = iTl + 1 + pack(p + iTl + 1);
+    writeRTC(PARAMS_RTC_HDR / 4, buf, (len + 3) & ~3);
+    hdr[0] = PARAMS_RTC_MAGIC;
+    hdr[1] = tok;
+    hdr[2] = crc32(p, len);
+    hdr[3] = len;
+    free(buf);
+  }
+  writeRTC(0, hdr, PARAMS_RTC_HDR);
+}
+
+
+inline uint32_t ParametersEEPROM::crc32(const uint8_t* aData, uint16_t aLen) {
+  uint32_t crc = 0xFFFFFFFFUL;
+
+  for (uint16_t j = 0; j < aLen; j++) {
+    crc ^= aData[j];
+    for (int i = 0; i < 8; i++) {
+      crc = ( crc & 1 ) ? (crc >> 1) ^ 0xEDB88320UL : crc >> 1;
+    }
+  }
+  return ~crc;
+}
+
+
+//  Gives this object its own RTC area: aOffset in 4-byte blocks, aSize in bytes (call before load())
+inline int8_t ParametersEEPROM::rtc(uint16_t aOffset, uint16_t aSize) {
+  if ( aSize < PARAMS_RTC_HDR + 4 || (uint32_t) aOffset * 4 + aSize > PARAMS_RTC_AREA ) return PARAMS_LEN;
+  iRtcOffset = aOffset;
+  iRtcSize = aSize & ~3;
+  return PARAMS_OK;
+}
+
+
+//  aOffset is in 4-byte blocks from the object's RTC area, aLen is in bytes and multiple of 4
+inline void ParametersEEPROM::readRTC(uint16_t aOffset, uint32_t* aData, uint16_t aLen) {
+#if defined( ARDUINO_ARCH_ESP8266 )
+  ESP.rtcUserMemoryRead(iRtcOffset + aOffset, aData, aLen);
+#else
+  memcpy(aData, __params_rtc() + iRtcOffset + aOffset, aLen);
+#endif
+}
+
+
+inline void ParametersEEPROM::writeRTC(uint16_t aOffset, uint32_t* aData, uint16_t aLen) {
+#if defined( ARDUINO_ARCH_ESP8266 )
+  ESP.rtcUserMemoryWrite(iRtcOffset + aOffset, aData, aLen);
+#else
+  memcpy(__params_rtc() + iRtcOffset + aOffset, aData, aLen);
+#endif
+}
+#endif // _PARAMS_RTC
+
+
+#ifdef _PARAMS_COMPRESS
+inline int8_t ParametersEEPROM::loadCompressed(const uint8_t* aHdr) {
+  uint16_t rawLen = aHdr[1] | ((((uint16_t) aHdr[2]) << 8) & 0xff00);
+  uint16_t zLen = aHdr[3] | ((((uint16_t) aHdr[4]) << 8) & 0xff00);
+  const uint8_t* z = aHdr + (PARAMS_EXT_HDR - 2);
+
+  if ( aHdr[0] != PARAMS_CODEC_LZ || z + zLen > iData + iSize - 1 || rawLen < 2 ) {
+    return PARAMS_FMT;
+  }
+
+  ParametersLZ lz(z, zLen);
+  int16_t c0 = lz.read();
+  int16_t c1 = lz.read();
+  if ( c0 < 0 || c1 < 0 ) return PARAMS_FMT;
+  uint16_t cnt = c0 | ((((uint16_t) c1) << 8) & 0xff00);
+  uint16_t n = 2;
+
+  // decompress straight into the dictionary: no full size buffer is needed
+  for (uint16_t i = 0; i < cnt; i++) {
+    String k;
+    String v;
+    int16_t c;
+    while ( (c = lz.read()) > 0 ) k.concat((char) c);
+    if ( c < 0 ) return PARAMS_FMT;
+    while ( (c = lz.read()) > 0 ) v.concat((char) c);
+    if ( c < 0 ) return PARAMS_FMT;
+    n += k.length() + v.length() + 2;
+    iDict(k, v);
+  }
+  return ( n == rawLen ) ? PARAMS_OK : PARAMS_FMT;
+}
+#endif
+
+
+//  Reads a single value directly from EEPROM without populating the dictionary.
+//  Indexed images (_PARAMS_INDEX) are searched in O(log n), raw images are scanned.
+//  Returns PARAMS_KEY if the key is not found, PARAMS_LEN if the value was truncated to aCap-1 chars
+inline int8_t ParametersEEPROM::get(const char* aKey, char* aBuf, uint16_t aCap) {
+  int8_t rc;
+
+  if (!iActive) {
+    return PARAMS_ACT;
+  }
+  if ( aCap == 0 ) return PARAMS_LEN;   // no room even for the terminator
+  beginEEPROM();
+  if ( !iVerified ) {
+    rc = verify();
+    if ( rc != PARAMS_OK ) return rc;
+  }
+
+  uint16_t end = iAddress + iSize - 1;
+  uint16_t a = iAddress + iToken.length() + 1;
+  uint16_t cnt = read16(a);
+  uint16_t v = 0;
+
+  if ( cnt == PARAMS_EXT_MARK ) {
+    if ( EEPROM.read(a + 2) != PARAMS_CODEC_IDX ) return PARAMS_FMT;
+    uint16_t s = a + PARAMS_EXT_HDR;
+    cnt = read16(s);
+    uint16_t idx = s + read16(a + 3) - 2 * cnt;
+    uint16_t lo = 0;
+    uint16_t hi = cnt;
+
+    while ( lo < hi ) {
+      uint16_t mid = (lo + hi) / 2;
+      uint16_t k = s + read16(idx + 2 * mid);
+      int8_t c = compare(k, aKey);
+      if ( c == 0 ) {
+        v = k + strlen(aKey) + 1;
+        break;
+      }
+      if ( c < 0 ) lo = mid + 1;
+      else hi = mid;
+    }
+  }
+  else {
+    uint16_t k = a + 2;
+    for (uint16_t i = 0; i < cnt && k < end; i++) {
+      bool found = ( compare(k, aKey) == 0 );
+      while ( k < end && EEPROM.read(k) ) k++;
+      k++;
+      if ( found ) {
+        v = k;
+        break;
+      }
+      while ( k < end && EEPROM.read(k) ) k++;
+      k++;
+    }
+  }
+  if ( v == 0 ) return PARAMS_KEY;
+
+  uint16_t i = 0;
+  uint8_t c;
+  while ( v < end && (c = EEPROM.read(v++)) != 0 ) {
+    if ( i + 1 >= aCap ) {
+      aBuf[i] = 0;
+      return PARAMS_LEN;
+    }
+    aBuf[i++] = c;
+  }
+  aBuf[i] = 0;
+  return PARAMS_OK;
+}
+
+
+//  Validates CRC and token of the stored image without allocating a buffer
+inline int8_t ParametersEEPROM::verify() {
+  uint8_t crc = 0;
+
+  for (uint16_t j = 0; j < iSize - 1; j++) {
+    crc ^= EEPROM.read(iAddress + j);
+    for (int i = 0; i < 8; i++) {
+      if ( crc & 0x80 )
+        crc = (uint8_t)((crc << 1) ^ CRCMASK);
+      else
+        crc <<= 1;
+    }
+  }
+  if ( crc != EEPROM.read(iAddress + iSize - 1) ) return PARAMS_CRC;
+  if ( compare(iAddress, iToken.c_str()) != 0 ) return PARAMS_TOK;
+  iVerified = true;
+  return PARAMS_OK;
+}
+
+
+inline uint16_t ParametersEEPROM::read16(uint16_t aAddr) {
+  return EEPROM.read(aAddr) | ((((uint16_t) EEPROM.read(aAddr + 1)) << 8) & 0xff00);
+}
+
+
+//  strcmp() of a null-terminated string stored in EEPROM at aAddr against aKey
+inline int8_t ParametersEEPROM::compare(uint16_t aAddr, const char* aKey) {
+  uint16_t end = iAddress + iSize - 1;
+  const uint8_t* k = (const uint8_t*) aKey;
+
+  for ( ; aAddr < end; aAddr++, k++) {
+    uint8_t c = EEPROM.read(aAddr);
+    if ( c != *k ) return ( c < *k ) ? -1 : 1;
+    if ( c == 0 ) return 0;
+  }
+  return 1;
+}
+
+
+inline void ParametersEEPROM::clear () {
   if (iData) {
     memset((void *) iData, 0, iSize - 1);
   }
 }
 
 
-#define CRCMASK 0x1d
-uint8_t ParametersEEPROM::checksum () {
+inline uint8_t ParametersEEPROM::checksum () {
   uint8_t crc = 0;
   uint8_t *ptr = (uint8_t *) iData;
 
@@ -36,8 +36,6 @@
 
 #ifndef EEPROM_MAX
 
-#define EEPROM_MAX  256 // safe default
-
 #if defined( ARDUINO_ARCH_AVR )
 #define EEPROM_MAX  512
 #endif
@@ -46,11 +44,15 @@
 #define EEPROM_MAX  4096
 #endif
 
+#ifndef EEPROM_MAX
+#define EEPROM_MAX  256 // safe default
+#endif
+
 #endif // #ifndef EEPROM_MAX
 
 class ParametersEEPROMMap : public ParametersBase {
   public:
-    ParametersEEPROMMap( const String& aToken, void* aPtr, void* aDeflt = NULL, uint16_t aAddress = 0, uint16_t aLength = (EEPROM_MAX-1) );
+    ParametersEEPROMMap( const ParametersToken& aToken, void* aPtr, void* aDeflt = NULL, uint16_t aAddress = 0, uint16_t aLength = (EEPROM_MAX-1) );
     virtual ~ParametersEEPROMMap();
 
     virtual int8_t  begin();
@@ -71,7 +73,7 @@ class ParametersEEPROMMap : public ParametersBase {
 
 };
 
-ParametersEEPROMMap::ParametersEEPROMMap(const String& aToken, void* aPtr, void* aDeflt, uint16_t aAddress, uint16_t aLength ) : ParametersBase(aToken)  {
+inline ParametersEEPROMMap::ParametersEEPROMMap(const ParametersToken& aToken, void* aPtr, void* aDeflt, uint16_t aAddress, uint16_t aLength ) : ParametersBase(aToken)  {
   iActive = false;
   iAddress = aAddress;
 
@@ -82,18 +84,20 @@ ParametersEEPROMMap::ParametersEEPROMMap(const String& aToken, void* aPtr, void*
 }
 
 
-ParametersEEPROMMap::~ParametersEEPROMMap() {
+inline ParametersEEPROMMap::~ParametersEEPROMMap() {
   if (iActive) {
     save();
 #if defined( ARDUINO_ARCH_ESP8266 ) || defined( ARDUINO_ARCH_ESP32 )
-    EEPROM.end();
+    // EEPROM.end() commits and releases the buffer shared by all objects:
+    // within a batch this is left to commitBatch()
+    if ( !inBatch() ) EEPROM.end();
 #endif
     iActive = false;
   }
 }
 
 
-int8_t ParametersEEPROMMap::begin() {
+inline int8_t ParametersEEPROMMap::begin() {
 
   if ( iMaxLen < 4 ) iMaxLen = 4;
   if ( iMaxLen <= EEPROM_MAX ) {
@@ -109,7 +113,7 @@ int8_t ParametersEEPROMMap::begin() {
 }
 
 
-int8_t ParametersEEPROMMap::load() {
+inline int8_t ParametersEEPROMMap::load() {
   uint8_t *ptr = (uint8_t *) iData;
 
   if (!iActive) {
@@ -134,7 +138,7 @@ int8_t ParametersEEPROMMap::load() {
 }
 
 
-int8_t ParametersEEPROMMap::save() {
+inline int8_t ParametersEEPROMMap::save() {
   uint8_t *ptr = (uint8_t *) iData;
   uint8_t changed = 0;
   int8_t  rc = PARAMS_OK;
@@ -172,16 +176,14 @@ int8_t ParametersEEPROMMap::save() {
 //  EEPROM.write( iAddress + iLen, checksum () );
 #endif
 #if defined( ARDUINO_ARCH_ESP8266 ) || defined( ARDUINO_ARCH_ESP32 )
-  if ( changed ) {
-    if ( !EEPROM.commit() ) rc = PARAMS_ERR;
-  }
+  if ( changed && commitEEPROM() != PARAMS_OK ) rc = PARAMS_ERR;
 #endif  
 
   return rc;
 }
 
 
-void ParametersEEPROMMap::loadDefaults () {
+inline void ParametersEEPROMMap::loadDefaults () {
   if ( iDefault ) {
     memcpy(iData, iDefault, iLen);
   }
@@ -192,13 +194,13 @@ void ParametersEEPROMMap::loadDefaults () {
 }
 
 
-void ParametersEEPROMMap::clear () {
+inline void ParametersEEPROMMap::clear () {
   memset( iData, 0, iLen );
 }
 
 
 #define CRCMASK 0x1d
-uint8_t ParametersEEPROMMap::checksum () {
+inline uint8_t ParametersEEPROMMap::checksum () {
   uint8_t crc = 0;
   uint8_t *ptr = (uint8_t *) iData;
 
@@ -0,0 +1,165 @@
+#ifndef _PARAMETERSLZ_H_
+#define _PARAMETERSLZ_H_
+
+/*
+  Copyright (c) 2015-2020, Anatoli Arkhipenko.
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without modification,
+  are permitted provided that the following conditions are met:
+
+  1. Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+
+  2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+  3. Neither the name of the copyright holder nor the names of its contributors
+   may be used to endorse or promote products derived from this software without
+   specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+  OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <Arduino.h>
+
+// Small footprint LZSS codec used to squeeze parameter images into EEPROM.
+// Stream layout: a flag byte precedes every group of 8 items, LSB first.
+//   flag bit 1 : literal byte
+//   flag bit 0 : back reference, 2 bytes: (distance - 1), (length - PARAMS_LZ_MINMATCH)
+// Decompression only needs a PARAMS_LZ_WINDOW byte history ring.
+
+#define PARAMS_LZ_WINDOW    256
+#define PARAMS_LZ_MINMATCH  3
+#define PARAMS_LZ_MAXMATCH  (PARAMS_LZ_MINMATCH + 255)
+
+class ParametersLZ {
+  public:
+    ParametersLZ(const uint8_t* aSrc, uint16_t aLen);
+
+    static uint16_t compress(const uint8_t* aSrc, uint16_t aLen, uint8_t* aDst, uint16_t aCap);
+    int16_t         read();
+
+  private:
+    const uint8_t*  iSrc;
+    uint16_t        iLen;
+    uint16_t        iPos;
+    uint8_t         iFlags;
+    uint8_t         iBits;
+    uint16_t        iDist;
+    uint16_t        iCopy;
+    uint8_t         iHead;
+    uint16_t        iFill;      // bytes of history, up to the window size
+    uint8_t         iWindow[PARAMS_LZ_WINDOW];
+};
+
+inline ParametersLZ::ParametersLZ(const uint8_t* aSrc, uint16_t aLen) {
+  iSrc = aSrc;
+  iLen = aLen;
+  iPos = 0;
+  iFlags = 0;
+  iBits = 0;
+  iDist = 0;
+  iCopy = 0;
+  iHead = 0;
+  iFill = 0;
+}
+
+
+//  Returns compressed length, or 0 if the result does not fit into aCap bytes
+inline uint16_t ParametersLZ::compress(const uint8_t* aSrc, uint16_t aLen, uint8_t* aDst, uint16_t aCap) {
+  uint16_t  i = 0;
+  uint16_t  o = 0;
+  uint16_t  flagPos = 0;
+  uint8_t   bit = 8;
+
+  while ( i < aLen ) {
+    if ( bit == 8 ) {
+      if ( o >= aCap ) return 0;
+      flagPos = o;
+      aDst[o++] = 0;
+      bit = 0;
+    }
+
+    uint16_t bestLen = 0;
+    uint16_t bestDist = 0;
+    uint16_t maxLen = aLen - i;
+    if ( maxLen > PARAMS_LZ_MAXMATCH ) maxLen = PARAMS_LZ_MAXMATCH;
+    uint16_t start = ( i > PARAMS_LZ_WINDOW ) ? i - PARAMS_LZ_WINDOW : 0;
+
+    for (uint16_t j = start; j < i; j++) {
+      uint16_t l = 0;
+      while ( l < maxLen && aSrc[j + l] == aSrc[i + l] ) l++;
+      if ( l > bestLen ) {
+        bestLen = l;
+        bestDist = i - j;
+        if ( l == maxLen ) break;
+      }
+    }
+
+    if ( bestLen >= PARAMS_LZ_MINMATCH ) {
+      if ( o + 2 > aCap ) return 0;
+      aDst[o++] = (uint8_t) (bestDist - 1);
+      aDst[o++] = (uint8_t) (bestLen - PARAMS_LZ_MINMATCH);
+      i += bestLen;
+    }
+    else {
+      if ( o >= aCap ) return 0;
+      aDst[flagPos] |= (1 << bit);
+      aDst[o++] = aSrc[i++];
+    }
+    bit++;
+  }
+  return o;
+}
+
+
+//  Returns next decompressed byte, or -1 at the end of compressed data. A reference to
+//  bytes that were not decoded yet (a corrupt image) also ends the data
+inline int16_t ParametersLZ::read() {
+  uint8_t c;
+
+  if ( iCopy ) {
+    c = iWindow[ (uint8_t)(iHead - iDist) ];
+    iCopy--;
+  }
+  else {
+    if ( iPos >= iLen ) return -1;
+    if ( iBits == 0 ) {
+      iFlags = iSrc[iPos++];
+      iBits = 8;
+      if ( iPos >= iLen ) return -1;
+    }
+    iBits--;
+    if ( iFlags & 1 ) {
+      c = iSrc[iPos++];
+    }
+    else {
+      if ( iPos + 2 > iLen ) return -1;
+      iDist = (uint16_t) iSrc[iPos++] + 1;
+      iCopy = (uint16_t) iSrc[iPos++] + PARAMS_LZ_MINMATCH - 1;
+      if ( iDist > iFill ) {
+        iCopy = 0;
+        iPos = iLen;
+        return -1;
+      }
+      c = iWindow[ (uint8_t)(iHead - iDist) ];
+    }
+    iFlags >>= 1;
+  }
+  iWindow[iHead++] = c;
+  if ( iFill < PARAMS_LZ_WINDOW ) iFill++;
+  return c;
+}
+
+#endif // _PARAMETERSLZ_H_
@@ -0,0 +1,319 @@
+#ifndef _PARAMETERSPOOL_H_
+#define _PARAMETERSPOOL_H_
+
+/*
+  Copyright (c) 2015-2020, Anatoli Arkhipenko.
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without modification,
+  are permitted provided that the following conditions are met:
+
+  1. Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+
+  2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+  3. Neither the name of the copyright holder nor the names of its contributors
+   may be used to endorse or promote products derived from this software without
+   specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+  OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <Arduino.h>
+
+#include <ParametersBase.h>
+#if !defined( _PARAMS_POOL )
+#include <Dictionary.h>   // only needed when it is the dictionary type
+#endif
+
+
+#ifndef PARAMS_POOL_ENTRIES
+#define PARAMS_POOL_ENTRIES   32    // number of key-value pairs
+#endif
+
+#ifndef PARAMS_POOL_BLOCKS
+#define PARAMS_POOL_BLOCKS    128   // number of storage blocks
+#endif
+
+#ifndef PARAMS_POOL_BLOCK
+#define PARAMS_POOL_BLOCK     16    // bytes per block
+#endif
+
+#define PARAMS_POOL_NIL       0xFFFF
+
+
+//  Key-value store with the Dictionary interface used by this library, kept in fixed-size
+//  blocks of a single area allocated once by the constructor. A pair takes a chain of
+//  blocks holding "key\0value\0". Config refreshes only move blocks between the pairs and
+//  the free list, so they never allocate from (and never fragment) the heap.
+//  Built with _PARAMS_POOL, ParametersDictionary is this class and all dictionary-based
+//  Parameters, JsonConfig and EspBootstrap objects store their values in the pool.
+class ParametersPool {
+  public:
+    ParametersPool(uint16_t aEntries = PARAMS_POOL_ENTRIES, uint16_t aBlocks = PARAMS_POOL_BLOCKS);
+    ~ParametersPool();
+
+    int8_t          insert(const char* aKey, const char* aValue);
+    inline int8_t   insert(const String& aKey, const String& aValue) { return insert(aKey.c_str(), aValue.c_str()); };
+    inline int8_t   operator()(const String& aKey, const String& aValue) { return insert(aKey.c_str(), aValue.c_str()); };
+    int8_t          remove(const String& aKey);
+    void            destroy();
+    int8_t          merge(ParametersPool& aSrc);
+
+    String          operator()(unsigned aIndex);                  // key
+    String          operator[](unsigned aIndex);                  // value
+    inline String   operator[](int aIndex) { return (*this)[(unsigned) aIndex]; };
+    String          operator[](const char* aKey);
+    inline String   operator[](const String& aKey) { return (*this)[aKey.c_str()]; };
+    inline String   search(const String& aKey) { return (*this)[aKey.c_str()]; };
+
+    inline unsigned count() { return iCount; };
+    size_t          esize();                                      // keys and values with terminators
+    inline size_t   size() { return iSize; };                     // memory taken by the pool
+    inline uint16_t available() { return iFreeCount; };          // free blocks
+    String          json();
+
+  private:
+    ParametersPool(const ParametersPool&);
+    ParametersPool& operator=(const ParametersPool&);
+
+    int             find(const char* aKey, uint16_t aLen);
+    uint16_t        chain(const char* aKey, uint16_t aKeyLen, const char* aValue, uint16_t aValueLen);
+    void            release(uint16_t aBlock);
+    String          read(uint16_t aEntry, uint16_t aOffset, uint16_t aLen);
+
+    uint16_t        iEntries;
+    uint16_t        iBlocks;
+    uint16_t        iCount;
+    uint16_t        iFree;
+    uint16_t        iFreeCount;
+    size_t          iSize;
+    uint16_t*       iHead;          // first block of each pair
+    uint16_t*       iKeyLen;
+    uint16_t*       iValueLen;
+    uint16_t*       iNext;          // next block of the chain or the free list
+    char*           iData;
+};
+
+
+#if defined( _PARAMS_POOL )
+typedef ParametersPool  ParametersDictionary;
+#else
+typedef Dictionary      ParametersDictionary;
+#endif
+
+
+inline ParametersPool::ParametersPool(uint16_t aEntries, uint16_t aBlocks) {
+  iEntries = aEntries;
+  iBlocks = ( aBlocks < PARAMS_POOL_NIL ) ? aBlocks : PARAMS_POOL_NIL - 1;
+  iCount = 0;
+  iSize = ( 3 * (size_t) iEntries + iBlocks ) * sizeof(uint16_t) + (size_t) iBlocks * PARAMS_POOL_BLOCK;
+
+  uint16_t* p = (uint16_t*) malloc(iSize);
+  if ( p == NULL ) {
+    iEntries = iBlocks = 0;
+    iSize = 0;
+  }
+  iHead = p;
+  iKeyLen = p + iEntries;
+  iValueLen = iKeyLen + iEntries;
+  iNext = iValueLen + iEntries;
+  iData = (char*) (iNext + iBlocks);
+  destroy();
+}
+
+
+inline ParametersPool::~ParametersPool() {
+  free(iHead);
+}
+
+
+inline void ParametersPool::destroy() {
+  iCount = 0;
+  iFreeCount = iBlocks;
+  iFree = iBlocks ? 0 : PARAMS_POOL_NIL;
+  for (uint16_t i = 0; i < iBlocks; i++) iNext[i] = ( i + 1 < iBlocks ) ? i + 1 : PARAMS_POOL_NIL;
+}
+
+
+//  Takes blocks off the free list and fills them with "key\0value\0"
+inline uint16_t ParametersPool::chain(const char* aKey, uint16_t aKeyLen, const char* aValue, uint16_t aValueLen) {
+  size_t len = (size_t) aKeyLen + aValueLen + 2;
+  uint16_t n = ( len + PARAMS_POOL_BLOCK - 1 ) / PARAMS_POOL_BLOCK;
+  uint16_t head = iFree;
+  uint16_t b = iFree;
+  size_t pos = 0;
+
+  for (uint16_t i = 0; i < n; i++, b = iNext[b]) {
+    char* d = iData + (size_t) b * PARAMS_POOL_BLOCK;
+    for (uint16_t j = 0; j < PARAMS_POOL_BLOCK && pos < len; j++, pos++) {
+      if ( pos < aKeyLen ) d[j] = aKey[pos];
+      else if ( pos == aKeyLen || pos == len - 1 ) d[j] = 0;
+      else d[j] = aValue[pos - aKeyLen - 1];
+    }
+    if ( i == n - 1 ) {
+      iFree = iNext[b];
+      iNext[b] = PARAMS_POOL_NIL;
+      break;
+    }
+  }
+  iFreeCount -= n;
+  return head;
+}
+
+
+inline void ParametersPool::release(uint16_t aBlock) {
+  while ( aBlock != PARAMS_POOL_NIL ) {
+    uint16_t next = iNext[aBlock];
+    iNext[aBlock] = iFree;
+    iFree = aBlock;
+    iFreeCount++;
+    aBlock = next;
+  }
+}
+
+
+//  Compares keys in place, without copying them out of the blocks
+inline int ParametersPool::find(const char* aKey, uint16_t aLen) {
+  for (uint16_t e = 0; e < iCount; e++) {
+    if ( iKeyLen[e] != aLen ) continue;
+    uint16_t b = iHead[e];
+    uint16_t i = 0;
+    while ( i < aLen ) {
+      const char* d = iData + (size_t) b * PARAMS_POOL_BLOCK;
+      uint16_t j = 0;
+      for (; j < PARAMS_POOL_BLOCK && i < aLen && d[j] == aKey[i]; j++, i++);
+      if ( j < PARAMS_POOL_BLOCK && i < aLen ) break;   // mismatch
+      b = iNext[b];
+    }
+    if ( i == aLen ) return e;
+  }
+  return -1;
+}
+
+
+inline String ParametersPool::read(uint16_t aEntry, uint16_t aOffset, uint16_t aLen) {
+  String s;
+  uint16_t b = iHead[aEntry];
+
+  s.reserve(aLen);
+  for (; aOffset >= PARAMS_POOL_BLOCK; aOffset -= PARAMS_POOL_BLOCK) b = iNext[b];
+  while ( aLen ) {
+    uint16_t n = PARAMS_POOL_BLOCK - aOffset;
+    if ( n > aLen ) n = aLen;
+    s.concat(iData + (size_t) b * PARAMS_POOL_BLOCK + aOffset, n);
+    aLen -= n;
+    aOffset = 0;
+    b = iNext[b];
+  }
+  return s;
+}
+
+
+//  Replacing a value succeeds only if the new one fits: the old value is kept otherwise
+inline int8_t ParametersPool::insert(const char* aKey, const char* aValue) {
+  size_t kl = strlen(aKey);
+  size_t vl = strlen(aValue);
+
+  if ( kl == 0 || kl + vl + 2 > (size_t) iBlocks * PARAMS_POOL_BLOCK ) return PARAMS_MEM;
+  uint16_t n = ( kl + vl + 2 + PARAMS_POOL_BLOCK - 1 ) / PARAMS_POOL_BLOCK;
+  int e = find(aKey, kl);
+
+  if ( e < 0 ) {
+    if ( iCount >= iEntries || n > iFreeCount ) return PARAMS_MEM;
+    e = iCount++;
+  }
+  else {
+    uint16_t old = ( iKeyLen[e] + iValueLen[e] + 2 + PARAMS_POOL_BLOCK - 1 ) / PARAMS_POOL_BLOCK;
+    if ( n > iFreeCount + old ) return PARAMS_MEM;
+    release(iHead[e]);
+  }
+  iHead[e] = chain(aKey, kl, aValue, vl);
+  iKeyLen[e] = kl;
+  iValueLen[e] = vl;
+  return PARAMS_OK;
+}
+
+
+inline int8_t ParametersPool::remove(const String& aKey) {
+  int e = find(aKey.c_str(), aKey.length());
+
+  if ( e < 0 ) return PARAMS_OK;
+  release(iHead[e]);
+  iCount--;
+  for (uint16_t i = e; i < iCount; i++) {
+    iHead[i] = iHead[i + 1];
+    iKeyLen[i] = iKeyLen[i + 1];
+    iValueLen[i] = iValueLen[i + 1];
+  }
+  return PARAMS_OK;
+}
+
+
+inline int8_t ParametersPool::merge(ParametersPool& aSrc) {
+  for (uint16_t i = 0; i < aSrc.count(); i++) {
+    int8_t rc = insert(aSrc(i).c_str(), aSrc[i].c_str());
+    if ( rc != PARAMS_OK ) return rc;
+  }
+  return PARAMS_OK;
+}
+
+
+inline String ParametersPool::operator()(unsigned aIndex) {
+  if ( aIndex >= iCount ) return String();
+  return read(aIndex, 0, iKeyLen[aIndex]);
+}
+
+
+inline String ParametersPool::operator[](unsigned aIndex) {
+  if ( aIndex >= iCount ) return String();
+  return read(aIndex, iKeyLen[aIndex] + 1, iValueLen[aIndex]);
+}
+
+
+inline String ParametersPool::operator[](const char* aKey) {
+  int e = find(aKey, strlen(aKey));
+
+  if ( e < 0 ) return String();
+  return read(e, iKeyLen[e] + 1, iValueLen[e]);
+}
+
+
+inline size_t ParametersPool::esize() {
+  size_t s = 0;
+
+  for (uint16_t i = 0; i < iCount; i++) s += iKeyLen[i] + iValueLen[i] + 2;
+  return s;
+}
+
+
+inline String ParametersPool::json() {
+  String s;
+
+  s.reserve(esize() + 4 * iCount + 2);
+  s = "{";
+  for (uint16_t i = 0; i < iCount; i++) {
+    if ( i ) s += ",";
+    s += "\"";
+    s += (*this)(i);
+    s += "\":\"";
+    s += (*this)[i];
+    s += "\"";
+  }
+  s += "}";
+  return s;
+}
+
+#endif // _PARAMETERSPOOL_H_
@@ -32,14 +32,20 @@
 */
 
 #include <ParametersBase.h>
-#include <Dictionary.h>
-#include <JsonConfigSPIFFS.h>
+#include <ParametersPool.h>
+#include <JsonConfig.h>
+#include <JsonConfigFileSource.h>
 
 #define PARAMS_FER  (-6)
 
+#ifndef PARAMS_FILE_LEN
+#define PARAMS_FILE_LEN   32    // "/<token>.json" with the terminator, SPIFFS names are up to 31 characters
+#endif
+
 class ParametersSPIFFS : public ParametersBase {
   public:
-    ParametersSPIFFS(const String& aToken, Dictionary& aDict ) ;
+    ParametersSPIFFS(const ParametersToken& aToken, ParametersDictionary& aDict);
+    ParametersSPIFFS(const ParametersToken& aToken, ParametersDictionary& aDict, fs::FS& aFS);
     virtual ~ParametersSPIFFS();
 
     virtual int8_t  begin();
@@ -50,16 +56,23 @@ class ParametersSPIFFS : public ParametersBase {
 
   private:
 
-    Dictionary&     iDict;
-    String          iFile;
+    ParametersDictionary& iDict;
+    fs::FS&         iFS;
+    char            iFile[PARAMS_FILE_LEN];
 };
 
-ParametersSPIFFS::ParametersSPIFFS(const String& aToken, Dictionary& aDict ) : ParametersBase(aToken), iDict(aDict)  {
+//  SPIFFS is only referenced, and linked in, if this constructor is used
+inline ParametersSPIFFS::ParametersSPIFFS(const ParametersToken& aToken, ParametersDictionary& aDict) : ParametersBase(aToken), iDict(aDict), iFS(SPIFFS)  {
+  iActive = false;
+}
+
+
+inline ParametersSPIFFS::ParametersSPIFFS(const ParametersToken& aToken, ParametersDictionary& aDict, fs::FS& aFS) : ParametersBase(aToken), iDict(aDict), iFS(aFS)  {
   iActive = false;
 }
 
 
-ParametersSPIFFS::~ParametersSPIFFS() {
+inline ParametersSPIFFS::~ParametersSPIFFS() {
   if (iActive) {
     save();
     iActive = false;
@@ -67,32 +80,39 @@ ParametersSPIFFS::~ParametersSPIFFS() {
 }
 
 
-int8_t ParametersSPIFFS::begin() {
+inline int8_t ParametersSPIFFS::begin() {
+  if ( (size_t) snprintf(iFile, PARAMS_FILE_LEN, "/%s.json", iToken.c_str()) >= PARAMS_FILE_LEN ) return PARAMS_LEN;
   iActive = true;
-  iFile = String("/") + iToken + ".json";
 #ifdef _LIBDEBUG_
-  Serial.printf("ParametersSPIFFS: config file = %s\n", iFile.c_str());
+  Serial.printf("ParametersSPIFFS: config file = %s\n", iFile);
 #endif
   return PARAMS_OK;
 }
 
 
-int8_t ParametersSPIFFS::load() {
+inline int8_t ParametersSPIFFS::load() {
 //  uint16_t iTl = iToken.length();
 
   if (!iActive) {
     return PARAMS_ACT;
   }
-  return JSONConfig.parse(iFile, iDict);
+
+  File f = iFS.open(iFile, "r");
+  if ( !f ) {
+    return JSON_FILENE;
+  }
+  int8_t rc = JsonConfig<JsonConfigFileSource, JsonConfigDictSink>::instance().parse(f, iDict);
+  f.close();
+  return rc;
 }
 
 
-int8_t ParametersSPIFFS::save() {
+inline int8_t ParametersSPIFFS::save() {
   if (!iActive) {
     return PARAMS_ACT;
   }
 
-  File f = SPIFFS.open(iFile, "w");
+  File f = iFS.open(iFile, "w");
   if ( !f ) {
     return PARAMS_FER;
   }
@@ -114,8 +134,8 @@ int8_t ParametersSPIFFS::save() {
 }
 
 
-void ParametersSPIFFS::clear () {
-  SPIFFS.remove(iFile);
+inline void ParametersSPIFFS::clear () {
+  iFS.remove(iFile);
 }
 
 #endif // _PARAMETERSSPIFFS_H_
\ No newline at end of file
@@ -0,0 +1,128 @@
+#ifndef _PARAMETERSSNAPSHOT_H_
+#define _PARAMETERSSNAPSHOT_H_
+
+/*
+  Copyright (c) 2015-2020, Anatoli Arkhipenko.
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without modification,
+  are permitted provided that the following conditions are met:
+
+  1. Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+
+  2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+  3. Neither the name of the copyright holder nor the names of its contributors
+   may be used to endorse or promote products derived from this software without
+   specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+  OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <Arduino.h>
+#include <atomic>
+
+//  Double-buffered (RCU style) holder of a configuration object (Dictionary or parameters structure)
+//  for configurations updated on one core and read on the other.
+//  Readers never block and always see a complete configuration. There should be only one writer:
+//
+//    JSONConfig.parse(url, cfg.edit());   // fills inactive copy
+//    cfg.publish();                       // atomic switch
+//
+//    ParametersSnapshot<Dictionary>::Reader r(cfg);
+//    r->search("key")                     // reader keeps the snapshot until r goes out of scope
+
+//  Dictionaries are copied with destroy() + merge(), everything else with assignment
+template<class T> auto __params_snapshot_copy(T& aDst, T& aSrc, int) -> decltype(aSrc.merge(aSrc), void()) {
+  aDst.destroy();
+  aDst.merge(aSrc);
+}
+
+template<class T> void __params_snapshot_copy(T& aDst, T& aSrc, long) {
+  aDst = aSrc;
+}
+
+
+template<class T>
+class ParametersSnapshot {
+  public:
+    ParametersSnapshot(T& aFirst, T& aSecond);
+
+    T&              edit();
+    void            publish();
+
+    uint8_t         acquire();
+    void            release(uint8_t aIndex);
+    inline T&       get(uint8_t aIndex) { return *iBuf[aIndex]; };
+
+    class Reader {
+      public:
+        Reader(ParametersSnapshot<T>& aSnap) : iSnap(aSnap) { iIndex = iSnap.acquire(); };
+        ~Reader() { iSnap.release(iIndex); };
+        inline T& operator*() { return iSnap.get(iIndex); };
+        inline T* operator->() { return &iSnap.get(iIndex); };
+
+      private:
+        ParametersSnapshot<T>&  iSnap;
+        uint8_t                 iIndex;
+    };
+
+  private:
+    T*                      iBuf[2];
+    std::atomic<uint32_t>   iCurrent;
+    std::atomic<uint32_t>   iReaders[2];
+};
+
+
+template<class T> ParametersSnapshot<T>::ParametersSnapshot(T& aFirst, T& aSecond) {
+  iBuf[0] = &aFirst;
+  iBuf[1] = &aSecond;
+  iCurrent = 0;
+  iReaders[0] = 0;
+  iReaders[1] = 0;
+}
+
+
+//  Returns inactive copy refreshed from the active one, once all readers left it
+template<class T> T& ParametersSnapshot<T>::edit() {
+  uint32_t b = 1 - iCurrent.load();
+
+  while ( iReaders[b].load() > 0 ) yield();
+  __params_snapshot_copy(*iBuf[b], *iBuf[1 - b], 0);
+  return *iBuf[b];
+}
+
+
+template<class T> void ParametersSnapshot<T>::publish() {
+  iCurrent.store( 1 - iCurrent.load() );
+}
+
+
+template<class T> uint8_t ParametersSnapshot<T>::acquire() {
+  for (;;) {
+    uint32_t i = iCurrent.load();
+    iReaders[i]++;
+    //  writer may have switched buffers in between - then retry with the new one
+    if ( iCurrent.load() == i ) return i;
+    iReaders[i]--;
+  }
+}
+
+
+template<class T> void ParametersSnapshot<T>::release(uint8_t aIndex) {
+  iReaders[aIndex]--;
+}
+
+#endif // _PARAMETERSSNAPSHOT_H_
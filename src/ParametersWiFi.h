@@ -0,0 +1,221 @@
+#ifndef _PARAMETERSWIFI_H_
+#define _PARAMETERSWIFI_H_
+
+/*
+  Copyright (c) 2015-2020, Anatoli Arkhipenko.
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without modification,
+  are permitted provided that the following conditions are met:
+
+  1. Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+
+  2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+  3. Neither the name of the copyright holder nor the names of its contributors
+   may be used to endorse or promote products derived from this software without
+   specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+  OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <Arduino.h>
+
+#include <ParametersEEPROMMap.h>
+
+#if defined( ARDUINO_ARCH_ESP8266 )
+#include <ESP8266WiFi.h>
+#endif
+
+#if defined( ARDUINO_ARCH_ESP32 )
+#include <WiFi.h>
+#endif
+
+#ifndef PARAMS_WIFI_SETS
+#define PARAMS_WIFI_SETS    4       // number of remembered networks
+#endif
+
+#ifndef PARAMS_WIFI_FAST
+#define PARAMS_WIFI_FAST    3000L   // ms to wait for a connection without a scan
+#endif
+
+#define PARAMS_WIFI_BSSID   0x01    // bssid and channel are valid
+#define PARAMS_WIFI_STATIC  0x02    // ip configuration is valid
+
+typedef struct {
+  char      ssid[33];
+  char      pwd[65];
+  uint8_t   bssid[6];
+  uint8_t   channel;
+  uint8_t   flags;
+  uint32_t  ip;
+  uint32_t  gateway;
+  uint32_t  mask;
+  uint32_t  dns;
+} ParametersWiFiSet;
+
+typedef struct {
+  char              token[16];
+  ParametersWiFiSet sets[PARAMS_WIFI_SETS];
+} ParametersWiFiData;
+
+
+//  Remembers WiFi credentials (last good first) with BSSID, channel and optionally the DHCP lease
+//  so the next connect could skip the scan (and DHCP). Stored in EEPROM as a memory map:
+//  record() writes to the flash only if connection details actually changed.
+class ParametersWiFi : public ParametersEEPROMMap {
+  public:
+    ParametersWiFi(const ParametersToken& aToken, uint16_t aAddress, bool aStaticIP = false);
+
+    virtual int8_t  begin();
+
+    int8_t          add(const char* aSsid, const char* aPwd);
+    int8_t          connect(uint32_t aTimeout);
+    int8_t          record();
+    int8_t          remember();
+    inline ParametersWiFiSet& set(uint8_t aIndex) { return iWiFi.sets[aIndex]; };
+
+  private:
+    bool            waitForWiFi(uint32_t aTimeout);
+    void            moveToFront(uint8_t aIndex);
+    int8_t          find(const char* aSsid);
+
+    ParametersWiFiData  iWiFi;
+    bool                iStaticIP;
+};
+
+
+inline ParametersWiFi::ParametersWiFi(const ParametersToken& aToken, uint16_t aAddress, bool aStaticIP) :
+  ParametersEEPROMMap(aToken, &iWiFi, NULL, aAddress, sizeof(ParametersWiFiData)) {
+  iStaticIP = aStaticIP;
+  memset(&iWiFi, 0, sizeof(ParametersWiFiData));
+}
+
+
+//  Token is kept at the start of the map: it has to fit the token field
+inline int8_t ParametersWiFi::begin() {
+  if ( iToken.length() >= sizeof(iWiFi.token) ) return PARAMS_LEN;
+  return ParametersEEPROMMap::begin();
+}
+
+
+//  Adds (or updates) credentials as the first network to try. Does not save.
+inline int8_t ParametersWiFi::add(const char* aSsid, const char* aPwd) {
+  if ( strlen(aSsid) >= sizeof(iWiFi.sets[0].ssid) || strlen(aPwd) >= sizeof(iWiFi.sets[0].pwd) ) {
+    return PARAMS_LEN;
+  }
+  int8_t i = find(aSsid);
+  if ( i < 0 ) i = PARAMS_WIFI_SETS - 1;  // forget the oldest one
+
+  ParametersWiFiSet& s = iWiFi.sets[i];
+  if ( strcmp(s.ssid, aSsid) != 0 || strcmp(s.pwd, aPwd) != 0 ) {
+    memset(&s, 0, sizeof(ParametersWiFiSet));
+    strcpy(s.ssid, aSsid);
+    strcpy(s.pwd, aPwd);
+  }
+  moveToFront(i);
+  return PARAMS_OK;
+}
+
+
+//  Tries remembered networks in order: first directly by bssid and channel,
+//  then with a regular scan. aTimeout applies to each scanning attempt.
+inline int8_t ParametersWiFi::connect(uint32_t aTimeout) {
+  WiFi.mode(WIFI_STA);
+
+  for (uint8_t i = 0; i < PARAMS_WIFI_SETS; i++) {
+    ParametersWiFiSet& s = iWiFi.sets[i];
+    if ( s.ssid[0] == 0 ) continue;
+
+    if ( s.flags & PARAMS_WIFI_BSSID ) {
+      if ( iStaticIP && (s.flags & PARAMS_WIFI_STATIC) ) {
+        WiFi.config( IPAddress(s.ip), IPAddress(s.gateway), IPAddress(s.mask), IPAddress(s.dns) );
+      }
+      WiFi.begin(s.ssid, s.pwd, s.channel, s.bssid);
+      if ( waitForWiFi(PARAMS_WIFI_FAST) ) return record();
+      WiFi.disconnect();
+      // access point may have moved or lease could be gone - fall back to dhcp and a scan
+      WiFi.config( IPAddress((uint32_t) 0), IPAddress((uint32_t) 0), IPAddress((uint32_t) 0) );
+    }
+    WiFi.begin(s.ssid, s.pwd);
+    if ( waitForWiFi(aTimeout) ) return record();
+    WiFi.disconnect();
+  }
+  return PARAMS_ERR;
+}
+
+
+//  Captures details of the current connection and saves them if anything changed
+inline int8_t ParametersWiFi::record() {
+  if ( WiFi.status() != WL_CONNECTED ) return PARAMS_ERR;
+
+  int8_t i = find(WiFi.SSID().c_str());
+  if ( i < 0 ) return PARAMS_KEY;   // not one of ours (credentials were never add()-ed)
+
+  ParametersWiFiSet& s = iWiFi.sets[i];
+  memcpy(s.bssid, WiFi.BSSID(), sizeof(s.bssid));
+  s.channel = WiFi.channel();
+  s.flags = PARAMS_WIFI_BSSID;
+  if ( iStaticIP ) {
+    s.ip = (uint32_t) WiFi.localIP();
+    s.gateway = (uint32_t) WiFi.gatewayIP();
+    s.mask = (uint32_t) WiFi.subnetMask();
+    s.dns = (uint32_t) WiFi.dnsIP();
+    s.flags |= PARAMS_WIFI_STATIC;
+  }
+  moveToFront(i);
+  return save();  // read-compare-write: no flash commit if nothing changed
+}
+
+
+//  Adds the network the device is connected to now (e.g. set up by EspBootstrap) and records it
+inline int8_t ParametersWiFi::remember() {
+  if ( WiFi.status() != WL_CONNECTED ) return PARAMS_ERR;
+
+  int8_t rc = add( WiFi.SSID().c_str(), WiFi.psk().c_str() );
+  if ( rc != PARAMS_OK ) return rc;
+  return record();
+}
+
+
+inline bool ParametersWiFi::waitForWiFi(uint32_t aTimeout) {
+  uint32_t timeNow = millis();
+
+  while ( WiFi.status() != WL_CONNECTED ) {
+    if ( millis() - timeNow > aTimeout ) return false;
+    delay(10);
+  }
+  return true;
+}
+
+
+inline void ParametersWiFi::moveToFront(uint8_t aIndex) {
+  if ( aIndex == 0 ) return;
+
+  ParametersWiFiSet s;
+  memcpy(&s, &iWiFi.sets[aIndex], sizeof(ParametersWiFiSet));
+  memmove(&iWiFi.sets[1], &iWiFi.sets[0], aIndex * sizeof(ParametersWiFiSet));
+  memcpy(&iWiFi.sets[0], &s, sizeof(ParametersWiFiSet));
+}
+
+
+inline int8_t ParametersWiFi::find(const char* aSsid) {
+  for (uint8_t i = 0; i < PARAMS_WIFI_SETS; i++) {
+    if ( strcmp(iWiFi.sets[i].ssid, aSsid) == 0 ) return i;
+  }
+  return -1;
+}
+
+#endif // _PARAMETERSWIFI_H_
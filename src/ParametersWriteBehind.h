@@ -0,0 +1,317 @@
+#ifndef _PARAMETERSWRITEBEHIND_H_
+#define _PARAMETERSWRITEBEHIND_H_
+
+/*
+  Copyright (c) 2015-2020, Anatoli Arkhipenko.
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without modification,
+  are permitted provided that the following conditions are met:
+
+  1. Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+
+  2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+  3. Neither the name of the copyright holder nor the names of its contributors
+   may be used to endorse or promote products derived from this software without
+   specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+  OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <Arduino.h>
+
+#include <ParametersBase.h>
+#include <ParametersPool.h>
+
+#if defined( ARDUINO_ARCH_ESP32 )
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
+#elif !defined( ARDUINO )
+#include <thread>
+#include <mutex>
+#include <atomic>
+#endif
+
+#ifndef PARAMS_WB_QUIET
+#define PARAMS_WB_QUIET     2000L   // flush after this many ms without new save() calls
+#endif
+
+#ifndef PARAMS_WB_DEADLINE
+#define PARAMS_WB_DEADLINE  30000L  // but never keep changes unsaved longer than this
+#endif
+
+#ifndef PARAMS_WB_TICK
+#define PARAMS_WB_TICK      100     // background task polling period, ms (ESP32, host builds)
+#endif
+
+//  Write-behind wrapper around any Parameters object:
+//  save() only marks parameters dirty, the actual save happens after the quiet period or deadline.
+//  On ESP32 a low priority FreeRTOS task does the flushing (a std::thread in host builds),
+//  elsewhere call poll() from the loop().
+//  Call flush() before a restart or deep sleep to write pending changes synchronously.
+//
+//  The wrapped object is built over a shadow copy of the data, which only the wrapper touches.
+//  save() copies the application's data into the shadow under the lock, so a background save
+//  never reads data the application is changing. save() waits only while a flush is running.
+class ParametersWriteBehind : public ParametersBase {
+  public:
+    ParametersWriteBehind(ParametersBase& aParams, ParametersDictionary& aLive, ParametersDictionary& aShadow, uint32_t aQuiet = PARAMS_WB_QUIET, uint32_t aDeadline = PARAMS_WB_DEADLINE);
+    ParametersWriteBehind(ParametersBase& aParams, void* aLive, void* aShadow, size_t aLen, uint32_t aQuiet = PARAMS_WB_QUIET, uint32_t aDeadline = PARAMS_WB_DEADLINE);
+    virtual ~ParametersWriteBehind();
+
+    virtual int8_t  begin();
+    virtual int8_t  load();
+    virtual int8_t  save();
+
+    int8_t          poll();
+    int8_t          flush();
+    inline bool     dirty() { return iDirty; };
+
+  private:
+    void            init(uint32_t aQuiet, uint32_t aDeadline);
+    void            stop();
+    void            lock();
+    void            unlock();
+
+    ParametersBase& iParams;
+    ParametersDictionary* iLive;
+    ParametersDictionary* iShadow;
+    void*           iLiveMem;
+    void*           iShadowMem;
+    size_t          iLen;
+    uint32_t        iQuiet;
+    uint32_t        iDeadline;
+    uint32_t        iFirst;
+    uint32_t        iLast;
+    volatile bool   iDirty;
+
+#if defined( ARDUINO_ARCH_ESP32 )
+    static void     task(void* aPtr);
+
+    TaskHandle_t      iTask;
+    SemaphoreHandle_t iMutex;
+#elif !defined( ARDUINO )
+    void            task();
+
+    std::thread*      iTask;
+    std::mutex        iMutex;
+    std::atomic<bool> iStop;
+#endif
+};
+
+
+//  Dictionary objects: aParams is constructed over aShadow, the application works with aLive
+inline ParametersWriteBehind::ParametersWriteBehind(ParametersBase& aParams, ParametersDictionary& aLive, ParametersDictionary& aShadow, uint32_t aQuiet, uint32_t aDeadline) : ParametersBase(aParams.token()), iParams(aParams) {
+  iLive = &aLive;
+  iShadow = &aShadow;
+  iLiveMem = NULL;
+  iShadowMem = NULL;
+  iLen = 0;
+  init(aQuiet, aDeadline);
+}
+
+
+//  Memory structures (ParametersEEPROMMap): aParams is constructed over aShadow
+inline ParametersWriteBehind::ParametersWriteBehind(ParametersBase& aParams, void* aLive, void* aShadow, size_t aLen, uint32_t aQuiet, uint32_t aDeadline) : ParametersBase(aParams.token()), iParams(aParams) {
+  iLive = NULL;
+  iShadow = NULL;
+  iLiveMem = aLive;
+  iShadowMem = aShadow;
+  iLen = aLen;
+  init(aQuiet, aDeadline);
+}
+
+
+inline void ParametersWriteBehind::init(uint32_t aQuiet, uint32_t aDeadline) {
+  iActive = false;
+  iQuiet = aQuiet;
+  iDeadline = aDeadline;
+  iFirst = 0;
+  iLast = 0;
+  iDirty = false;
+#if defined( ARDUINO_ARCH_ESP32 )
+  iTask = NULL;
+  iMutex = NULL;
+#elif !defined( ARDUINO )
+  iTask = NULL;
+  iStop = false;
+#endif
+}
+
+
+inline ParametersWriteBehind::~ParametersWriteBehind() {
+  if (iActive) {
+    stop();
+    flush();
+    iActive = false;
+  }
+#if defined( ARDUINO_ARCH_ESP32 )
+  if ( iMutex ) vSemaphoreDelete(iMutex);
+#endif
+}
+
+
+inline int8_t ParametersWriteBehind::begin() {
+  int8_t rc = iParams.begin();
+  if ( rc != PARAMS_OK ) return rc;
+
+#if defined( ARDUINO_ARCH_ESP32 )
+  if ( iMutex == NULL ) {
+    iMutex = xSemaphoreCreateMutex();
+    if ( iMutex == NULL ) return PARAMS_MEM;
+  }
+  if ( iTask == NULL ) {
+    if ( xTaskCreate(task, "ParamsWB", 4096, this, tskIDLE_PRIORITY + 1, &iTask) != pdPASS ) {
+      iTask = NULL;
+      return PARAMS_MEM;
+    }
+  }
+#elif !defined( ARDUINO )
+  if ( iTask == NULL ) {
+    iStop = false;
+    iTask = new std::thread(&ParametersWriteBehind::task, this);
+  }
+#endif
+  iActive = true;
+  return PARAMS_OK;
+}
+
+
+//  Loads into the shadow copy and hands the result over to the application
+inline int8_t ParametersWriteBehind::load() {
+  if (!iActive) {
+    return PARAMS_ACT;
+  }
+  lock();
+  int8_t rc = iParams.load();
+  if ( iLive ) {
+    iLive->destroy();
+    if ( iLive->merge(*iShadow) ) rc = PARAMS_MEM;
+  }
+  else {
+    memcpy(iLiveMem, iShadowMem, iLen);
+  }
+  unlock();
+  return rc;
+}
+
+
+inline int8_t ParametersWriteBehind::save() {
+  int8_t rc = PARAMS_OK;
+
+  if (!iActive) {
+    return PARAMS_ACT;
+  }
+  lock();
+  if ( iLive ) {
+    iShadow->destroy();
+    if ( iShadow->merge(*iLive) ) rc = PARAMS_MEM;
+  }
+  else {
+    memcpy(iShadowMem, iLiveMem, iLen);
+  }
+  iLast = millis();
+  if ( !iDirty ) iFirst = iLast;
+  iDirty = true;
+  unlock();
+  return rc;
+}
+
+
+//  Flushes pending changes if the quiet period or the deadline has passed
+inline int8_t ParametersWriteBehind::poll() {
+  bool due = false;
+
+  lock();
+  if ( iDirty ) {
+    uint32_t now = millis();
+    due = ( now - iLast >= iQuiet || now - iFirst >= iDeadline );
+  }
+  unlock();
+  return due ? flush() : PARAMS_OK;
+}
+
+
+inline int8_t ParametersWriteBehind::flush() {
+  int8_t rc = PARAMS_OK;
+
+  lock();
+  if ( iDirty ) {
+    rc = iParams.save();
+    if ( rc == PARAMS_OK ) iDirty = false;
+  }
+  unlock();
+  return rc;
+}
+
+
+inline void ParametersWriteBehind::lock() {
+#if defined( ARDUINO_ARCH_ESP32 )
+  if ( iMutex ) xSemaphoreTake(iMutex, portMAX_DELAY);
+#elif !defined( ARDUINO )
+  iMutex.lock();
+#endif
+}
+
+
+inline void ParametersWriteBehind::unlock() {
+#if defined( ARDUINO_ARCH_ESP32 )
+  if ( iMutex ) xSemaphoreGive(iMutex);
+#elif !defined( ARDUINO )
+  iMutex.unlock();
+#endif
+}
+
+
+//  The background flusher is stopped outside of a flush, so it never dies holding the lock
+inline void ParametersWriteBehind::stop() {
+#if defined( ARDUINO_ARCH_ESP32 )
+  lock();
+  if ( iTask ) vTaskDelete(iTask);
+  iTask = NULL;
+  unlock();
+#elif !defined( ARDUINO )
+  if ( iTask ) {
+    iStop = true;
+    iTask->join();
+    delete iTask;
+    iTask = NULL;
+  }
+#endif
+}
+
+
+#if defined( ARDUINO_ARCH_ESP32 )
+inline void ParametersWriteBehind::task(void* aPtr) {
+  ParametersWriteBehind* p = (ParametersWriteBehind*) aPtr;
+
+  for (;;) {
+    vTaskDelay( PARAMS_WB_TICK / portTICK_PERIOD_MS );
+    p->poll();
+  }
+}
+#elif !defined( ARDUINO )
+//  Host builds (tests on Linux): the same deferred flushing from a thread
+inline void ParametersWriteBehind::task() {
+  while ( !iStop ) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(PARAMS_WB_TICK));
+    poll();
+  }
+}
+#endif
+
+#endif // _PARAMETERSWRITEBEHIND_H_